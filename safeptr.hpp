@@ -1,22 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
+#if defined(__cpp_lib_memory_resource)
+#define SAFEPTR_HAS_PMR 1
+#else
+#define SAFEPTR_HAS_PMR 0
+#endif
+
+#include "safeptr_config.hpp"
+#include "safeptr_convert.hpp"
+#include "safeptr_copy.hpp"
+
+// Source of SafePointer storage. Sizes and alignments are in bytes; failures are
+// reported by returning nullptr, like malloc.
+class SafeBackend
+{
+public:
+    virtual ~SafeBackend() = default;
+
+    virtual void* allocate(size_t bytes, size_t align) = 0;
+    virtual void deallocate(void* ptr, size_t bytes, size_t align) = 0;
+
+    virtual void* callocate(size_t bytes, size_t align) {
+        void* ptr = allocate(bytes, align);
+        if (ptr) {
+            memset(ptr, 0, bytes);
+        }
+        return ptr;
+    }
+
+    // Keeps the contents up to the smaller size; the old block is untouched on failure.
+    virtual void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) {
+        void* new_ptr = allocate(new_bytes, align);
+        if (!new_ptr) {
+            return nullptr;
+        }
+        if (ptr) {
+            memcpy(new_ptr, ptr, std::min(old_bytes, new_bytes));
+            deallocate(ptr, old_bytes, align);
+        }
+        return new_ptr;
+    }
+
+    // Called by SafePointer::clone() once the copy in dst (a block of this backend)
+    // is complete, so decorators can tell clones apart from fresh allocations.
+    virtual void on_clone(const void*, const void*, size_t) {}
+
+    // Backend used by SafePointers that were not given one explicitly: the calling
+    // thread's default if set, else the process default.
+    static SafeBackend& get_default();
+    // The process default alone, ignoring any thread default.
+    static SafeBackend& get_process_default();
+    static void set_default(SafeBackend* backend);  // nullptr restores MallocBackend
+    // Returns the previous thread default; nullptr falls back to the process default.
+    static SafeBackend* set_thread_default(SafeBackend* backend);
+
+private:
+    static std::atomic<SafeBackend*>& default_slot() {
+        static std::atomic<SafeBackend*> slot{nullptr};
+        return slot;
+    }
+
+    static SafeBackend*& thread_slot() {
+        static thread_local SafeBackend* slot = nullptr;
+        return slot;
+    }
+};
+
+class MallocBackend : public SafeBackend
+{
+public:
+    void* allocate(size_t bytes, size_t align) override {
+        if (align <= alignof(std::max_align_t)) {
+            return malloc(bytes);
+        }
+        return aligned_alloc(align, (bytes + align - 1) / align * align);
+    }
+
+    void deallocate(void* ptr, size_t, size_t) override { free(ptr); }
+
+    void* callocate(size_t bytes, size_t align) override {
+        if (align <= alignof(std::max_align_t)) {
+            return calloc(bytes, 1);
+        }
+        return SafeBackend::callocate(bytes, align);
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        if (align <= alignof(std::max_align_t)) {
+            return realloc(ptr, new_bytes);
+        }
+        return SafeBackend::reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    static MallocBackend& instance() {
+        static MallocBackend backend;
+        return backend;
+    }
+};
+
+// Storage from the global operator new, returned with sized (and, for over-aligned
+// blocks, aligned) operator delete. Allocators that replace them, such as tcmalloc,
+// jemalloc or mimalloc, then skip the size-class lookup on free.
+class OperatorNewBackend : public SafeBackend
+{
+public:
+    void* allocate(size_t bytes, size_t align) override {
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return ::operator new(bytes, std::align_val_t(align), std::nothrow);
+        }
+        return ::operator new(bytes, std::nothrow);
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+#if defined(__cpp_sized_deallocation)
+            ::operator delete(ptr, bytes, std::align_val_t(align));
+#else
+            ::operator delete(ptr, std::align_val_t(align));
+#endif
+            return;
+        }
+#if defined(__cpp_sized_deallocation)
+        ::operator delete(ptr, bytes);
+#else
+        ::operator delete(ptr);
+#endif
+    }
+
+    static OperatorNewBackend& instance() {
+        static OperatorNewBackend backend;
+        return backend;
+    }
+};
+
+#if SAFEPTR_HAS_PMR
+// Adapter drawing SafePointer storage from a std::pmr::memory_resource (nullptr:
+// the pmr default resource). Either the caller owns one alongside the resource,
+//
+//     PmrBackend backend(&request_arena);
+//     SafePointer<char> buf(n, &backend);
+//
+// or SafePointer(n, &request_arena) creates a reference-counted adapter inside the
+// resource itself, shared by the SafePointers moved from it and released with the
+// last of them; no process-wide table is involved. Either way the resource must
+// outlive the SafePointers using it.
+//
+// Resources cannot resize blocks, so reallocation is allocate + copy + deallocate;
+// blocks are returned with the exact size and alignment they were obtained with.
+class PmrBackend : public SafeBackend
+{
+private:
+    std::pmr::memory_resource* resource_;
+    std::atomic<size_t> refs_{0};  // only for adapters from create_shared()
+
+public:
+    explicit PmrBackend(std::pmr::memory_resource* resource)
+        : resource_(resource ? resource : std::pmr::get_default_resource()) {}
+
+    void* allocate(size_t bytes, size_t align) override {
+        try {
+            return resource_->allocate(bytes, align);
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override { resource_->deallocate(ptr, bytes, align); }
+
+    std::pmr::memory_resource* resource() const { return resource_; }
+
+    // Adapter placed in the resource's own memory with one reference; see release().
+    static PmrBackend* create_shared(std::pmr::memory_resource* resource) {
+        if (!resource) {
+            resource = std::pmr::get_default_resource();
+        }
+        void* memory;
+        try {
+            memory = resource->allocate(sizeof(PmrBackend), alignof(PmrBackend));
+        } catch (const std::bad_alloc&) {
+            throw std::runtime_error("Memory allocation failed");
+        }
+        PmrBackend* backend = new (memory) PmrBackend(resource);
+        backend->refs_.store(1, std::memory_order_relaxed);
+        return backend;
+    }
+
+    void retain() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Drops a reference to a create_shared() adapter, destroying it with the last one.
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::pmr::memory_resource* resource = resource_;
+            this->~PmrBackend();
+            resource->deallocate(this, sizeof(PmrBackend), alignof(PmrBackend));
+        }
+    }
+};
+#endif
+
+inline SafeBackend& SafeBackend::get_default() {
+    SafeBackend* backend = thread_slot();
+    return backend ? *backend : get_process_default();
+}
+
+inline SafeBackend& SafeBackend::get_process_default() {
+    SafeBackend* backend = default_slot().load(std::memory_order_acquire);
+    return backend ? *backend : MallocBackend::instance();
+}
+
+inline void SafeBackend::set_default(SafeBackend* backend) {
+    default_slot().store(backend, std::memory_order_release);
+}
+
+inline SafeBackend* SafeBackend::set_thread_default(SafeBackend* backend) {
+    SafeBackend* previous = thread_slot();
+    thread_slot() = backend;
+    return previous;
+}
+
+namespace safeptr_detail {
+
+// Storage for SafePointers built during constant evaluation, where neither malloc
+// nor the backends are available: every element is value-initialised.
+template <typename T>
+SAFEPTR_CONSTEXPR T* constant_allocate(size_t n) {
+    T* ptr = std::allocator<T>().allocate(n);
+    for (size_t i = 0; i < n; ++i) {
+#if SAFEPTR_CONSTEXPR_ALLOC
+        std::construct_at(ptr + i);
+#else
+        ::new (static_cast<void*>(ptr + i)) T();
+#endif
+    }
+    return ptr;
+}
+
+template <typename T>
+SAFEPTR_CONSTEXPR void constant_deallocate(T* ptr, size_t n) {
+    std::destroy(ptr, ptr + n);
+    std::allocator<T>().deallocate(ptr, n);
+}
+
+}  // namespace safeptr_detail
 
 template <typename T>
 class SafePointer
 {
 private:
+    using Mutable = typename std::remove_const<T>::type;
+
     T* ptr_ = nullptr;
     bool allocated_ = false;
-    size_t size_;  // size in terms of elements, not bytes
+    bool owning_ = true;  // false for views over storage this SafePointer must not free
+    bool shared_backend_ = false;  // backend_ is a PmrBackend::create_shared() reference
+    size_t size_ = 0;  // size in terms of elements, not bytes
+    size_t bytes_ = 0;  // size of the current block in bytes
+    SafeBackend* backend_ = nullptr;  // owner of the current block; default backend if null
+
+    // Points backend_ at backend, holding a reference if it is shared.
+    SAFEPTR_CONSTEXPR void set_backend(SafeBackend* backend, bool shared) {
+#if SAFEPTR_HAS_PMR
+        if (shared) {
+            static_cast<PmrBackend*>(backend)->retain();
+        }
+        if (shared_backend_) {
+            static_cast<PmrBackend*>(backend_)->release();
+        }
+#endif
+        backend_ = backend;
+        shared_backend_ = shared;
+    }
+
 public:
-    SafePointer() = default;
-    explicit SafePointer(size_t size) { allocate(size); }
-    ~SafePointer() { deallocate(); }
+    SAFEPTR_CONSTEXPR SafePointer() = default;
+    SAFEPTR_CONSTEXPR explicit SafePointer(size_t size) { allocate(size); }
+    SAFEPTR_CONSTEXPR explicit SafePointer(SafeBackend* backend) : backend_(backend) {}
+    SAFEPTR_CONSTEXPR SafePointer(size_t size, SafeBackend* backend) : backend_(backend) { allocate(size); }
+#if SAFEPTR_HAS_PMR
+    explicit SafePointer(std::pmr::memory_resource* resource)
+        : shared_backend_(true), backend_(PmrBackend::create_shared(resource)) {}
+    SafePointer(size_t size, std::pmr::memory_resource* resource) : SafePointer(resource) { allocate(size); }
+#endif
+    SAFEPTR_CONSTEXPR SafePointer(const SafePointer<T>& other) {
+        if (other.allocated_) {
+            *this = other;
+        }
+    }
+    SAFEPTR_CONSTEXPR SafePointer(SafePointer<T>&& other) noexcept { move(std::move(other)); }
+    SAFEPTR_CONSTEXPR ~SafePointer() {
+        deallocate();
+        set_backend(nullptr, false);
+    }
 
-    void allocate(size_t size) {
+    SAFEPTR_CONSTEXPR void allocate(size_t size) {
         if (size == 0) {
             throw std::invalid_argument("Cannot allocate 0 elements");
         }
@@ -24,30 +319,52 @@ public:
             reallocate(size);
             return;
         }
-        ptr_ = (T*)malloc(size * sizeof(T));  // Allocate memory based on element size
+        if (SAFEPTR_CONSTANT_EVALUATED()) {
+            ptr_ = safeptr_detail::constant_allocate<Mutable>(size);
+            size_ = size;
+            bytes_ = size * sizeof(T);
+            allocated_ = true;
+            return;
+        }
+        if (!backend_) {
+            backend_ = &SafeBackend::get_default();
+        }
+        ptr_ = (T*)backend_->allocate(size * sizeof(T), alignof(T));  // Allocate memory based on element size
         if (!ptr_) {
             throw std::runtime_error("Memory allocation failed");
         }
         size_ = size;
+        bytes_ = size * sizeof(T);
         allocated_ = true;
     }
 
-    void callocate(size_t num, size_t size) {
+    SAFEPTR_CONSTEXPR void callocate(size_t num, size_t size) {
         if (num == 0 || size == 0) {
             throw std::invalid_argument("Cannot allocate 0 elements or size");
         }
         if (allocated_) {
             deallocate();
         }
-        ptr_ = (T*)calloc(num, size);  // Allocate memory for 'num' elements of size
+        if (num > SIZE_MAX / size) {
+            throw std::runtime_error("Memory allocation failed");
+        }
+        if (SAFEPTR_CONSTANT_EVALUATED()) {
+            allocate(num);  // constant-evaluated storage is always value-initialised
+            return;
+        }
+        if (!backend_) {
+            backend_ = &SafeBackend::get_default();
+        }
+        ptr_ = (T*)backend_->callocate(num * size, alignof(T));  // Allocate memory for 'num' elements of size
         if (!ptr_) {
             throw std::runtime_error("Memory allocation failed");
         }
         size_ = num;
+        bytes_ = num * size;
         allocated_ = true;
     }
 
-    void reallocate(size_t size) {
+    SAFEPTR_CONSTEXPR void reallocate(size_t size) {
         if (size == 0) {
             throw std::invalid_argument("Cannot reallocate to 0 elements");
         }
@@ -55,38 +372,62 @@ public:
             allocate(size);
             return;
         }
-        T* new_ptr = (T*)realloc((void*)ptr_, size * sizeof(T));  // Reallocate memory based on element size
+        if (SAFEPTR_CONSTANT_EVALUATED()) {
+            Mutable* new_ptr = safeptr_detail::constant_allocate<Mutable>(size);
+            std::copy(ptr_, ptr_ + std::min(size, size_), new_ptr);
+            safeptr_detail::constant_deallocate(const_cast<Mutable*>(ptr_), size_);
+            ptr_ = new_ptr;
+            size_ = size;
+            bytes_ = size * sizeof(T);
+            return;
+        }
+        if (!owning_) {
+            throw std::runtime_error("Cannot reallocate a non-owning SafePointer");
+        }
+        T* new_ptr = (T*)backend_->reallocate((void*)ptr_, bytes_, size * sizeof(T), alignof(T));  // Reallocate memory based on element size
         if (!new_ptr) {
             throw std::runtime_error("Memory reallocation failed");
         }
         size_ = size;
+        bytes_ = size * sizeof(T);
         ptr_ = new_ptr;
     }
 
-    void deallocate() {
+    SAFEPTR_CONSTEXPR void deallocate() {
         if (allocated_) {
-            free((void*)ptr_);
+            if (ptr_ && owning_) {
+                if (SAFEPTR_CONSTANT_EVALUATED()) {
+                    safeptr_detail::constant_deallocate(const_cast<Mutable*>(ptr_), size_);
+                } else {
+                    backend_->deallocate((void*)ptr_, bytes_, alignof(T));
+                }
+            }
             ptr_ = nullptr;
             allocated_ = false;
+            owning_ = true;
             size_ = 0;
+            bytes_ = 0;
         }
     }
 
-    bool is_allocated() const { return allocated_; }
-    T* get() const { return ptr_; }
-    size_t size() const { return size_; }
-    bool is_empty() const { return allocated_ && size_ == 0; }
+    SAFEPTR_CONSTEXPR bool is_allocated() const { return allocated_; }
+    SAFEPTR_CONSTEXPR bool is_owning() const { return allocated_ && owning_; }
+    SAFEPTR_CONSTEXPR T* get() const { return ptr_; }
+    SAFEPTR_CONSTEXPR size_t size() const { return size_; }
+    SAFEPTR_CONSTEXPR SafeBackend* backend() const { return backend_; }
+    SAFEPTR_CONSTEXPR bool is_empty() const { return allocated_ && size_ == 0; }
 
-    void clear(bool doDeallocate = false) {
+    SAFEPTR_CONSTEXPR void clear(bool doDeallocate = false) {
         if (doDeallocate) {
             deallocate();  // Frees the memory if doDeallocate is true
         } else {
             ptr_ = nullptr;  // Just clears the pointer without deallocating
             size_ = 0;       // Resets the size to 0
+            bytes_ = 0;
         }
     }
 
-    void resize(size_t size) {
+    SAFEPTR_CONSTEXPR void resize(size_t size) {
         if (size == size_) return;
         if (size == 0) {
             deallocate();
@@ -95,31 +436,58 @@ public:
         reallocate(size);
     }
 
-    void fill(T *begin, T *end, const T& value) {
+    SAFEPTR_CONSTEXPR void fill(T *begin, T *end, const T& value) {
         if (!allocated_ || ptr_ == nullptr) {
             throw std::runtime_error("Cannot fill: memory is not allocated");
         }
         std::fill(begin, end, value);
     }
 
-    void fill(const T& value) {
+    SAFEPTR_CONSTEXPR void fill(const T& value) {
         fill(begin(), end(), value);
     }
 
-    void swap(SafePointer<T>& other) {
+    SAFEPTR_CONSTEXPR void swap(SafePointer<T>& other) {
         std::swap(ptr_, other.ptr_);
         std::swap(allocated_, other.allocated_);
+        std::swap(owning_, other.owning_);
+        std::swap(shared_backend_, other.shared_backend_);
         std::swap(size_, other.size_);
+        std::swap(bytes_, other.bytes_);
+        std::swap(backend_, other.backend_);
     }
 
-    SafePointer<T> clone() const {
+    SAFEPTR_CONSTEXPR SafePointer<T> clone() const {
         SafePointer<T> new_sptr;
         new_sptr.allocate(size_);
-        std::copy(ptr_, ptr_ + size_, new_sptr.ptr_);
+        safeptr_detail::copy_elements<Mutable>(ptr_, ptr_ + size_, const_cast<Mutable*>(new_sptr.ptr_));
+        if (!SAFEPTR_CONSTANT_EVALUATED()) {
+            new_sptr.backend_->on_clone(ptr_, new_sptr.ptr_, new_sptr.bytes_);
+        }
         return new_sptr;
     }
 
-    bool compare(const SafePointer<T>& other) const {
+    // Element-wise conversion into dst, (re)allocated to size() elements. Values are
+    // multiplied by scale; float->integer and integer narrowing round and saturate.
+    template <typename U>
+    void convert_into(SafePointer<U>& dst, double scale = 1.0) const {
+        if (!allocated_ || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot convert from an unallocated SafePointer");
+        }
+        if (!dst.is_allocated() || dst.size() != size_) {
+            dst.allocate(size_);
+        }
+        SafeConvert<T, U>::run(ptr_, dst.get(), size_, scale);
+    }
+
+    template <typename U>
+    SafePointer<U> convert_to(double scale = 1.0) const {
+        SafePointer<U> new_sptr;
+        convert_into(new_sptr, scale);
+        return new_sptr;
+    }
+
+    SAFEPTR_CONSTEXPR bool compare(const SafePointer<T>& other) const {
         return ptr_ == other.ptr_;
     }
 
@@ -129,38 +497,47 @@ public:
         }
         ptr_ = ptr;
         allocated_ = (ptr_ != nullptr);
+        owning_ = true;
+        bytes_ = 0;
+        set_backend(&MallocBackend::instance(), false);  // adopted pointers come from malloc
     }
 
-    void copy(const SafePointer<T>& other, size_t size) {
+    SAFEPTR_CONSTEXPR void copy(const SafePointer<T>& other, size_t size) {
         if (!other.is_allocated()) {
             throw std::runtime_error("Cannot copy from an unallocated SafePointer");
         }
         allocate(size);
-        std::copy(other.ptr_, other.ptr_ + size, ptr_);
+        safeptr_detail::copy_elements<Mutable>(other.ptr_, other.ptr_ + size, const_cast<Mutable*>(ptr_));
     }
 
-    void move(SafePointer<T>&& other) {
+    SAFEPTR_CONSTEXPR void move(SafePointer<T>&& other) {
         if (this != &other) {
             deallocate();
             ptr_ = other.ptr_;
             allocated_ = other.allocated_;
+            owning_ = other.owning_;
+            size_ = other.size_;
+            bytes_ = other.bytes_;
+            set_backend(other.backend_, other.shared_backend_);
             other.ptr_ = nullptr;
             other.allocated_ = false;
+            other.owning_ = true;
             other.size_ = 0;
+            other.bytes_ = 0;
         }
     }
 
-    T* begin() const { return ptr_; }
-    T* end() const { return ptr_ + size_; }
+    SAFEPTR_CONSTEXPR T* begin() const { return ptr_; }
+    SAFEPTR_CONSTEXPR T* end() const { return ptr_ + size_; }
 
-    void set_value(const T& value, size_t idx = 0) {
+    SAFEPTR_CONSTEXPR void set_value(const T& value, size_t idx = 0) {
         if (!allocated_ || ptr_ == nullptr) {
             throw std::runtime_error("Cannot set value: memory is not allocated");
         }
         ptr_[idx] = value;
     }
 
-    void set_values(const T* src_begin, const T* src_end, T* dst_begin) {
+    SAFEPTR_CONSTEXPR void set_values(const T* src_begin, const T* src_end, T* dst_begin) {
         if (!allocated_ || ptr_ == nullptr) {
             throw std::runtime_error("Cannot set values: memory is not allocated");
         }
@@ -176,14 +553,69 @@ public:
             throw std::invalid_argument("Source range exceeds destination space");
         }
 
-        std::copy(src_begin, src_end, dst_begin);
+        if (SAFEPTR_CONSTANT_EVALUATED()) {
+            // Pointers into unrelated objects cannot be ordered here; stage the source instead.
+            Mutable* tmp = safeptr_detail::constant_allocate<Mutable>(src_count);
+            std::copy(src_begin, src_end, tmp);
+            std::copy(tmp, tmp + src_count, dst_begin);
+            safeptr_detail::constant_deallocate(tmp, src_count);
+            return;
+        }
+        if (reinterpret_cast<uintptr_t>(src_begin) < reinterpret_cast<uintptr_t>(dst_begin + src_count) &&
+            reinterpret_cast<uintptr_t>(dst_begin) < reinterpret_cast<uintptr_t>(src_end)) {
+            safeptr_detail::move_elements(src_begin, src_end, dst_begin);  // source overlaps the destination
+            return;
+        }
+        safeptr_detail::copy_elements(src_begin, src_end, dst_begin);
     }
 
-    void set_values(const T* src_begin, const T* src_end) {
+    SAFEPTR_CONSTEXPR void set_values(const T* src_begin, const T* src_end) {
         set_values(src_begin, src_end, begin());
     }
 
-    void get_values(const T* src_begin, const T* src_end, T* dst_begin) const {
+    // Moves count elements from src_offset to dst_offset; the ranges may overlap.
+    void move_within(size_t src_offset, size_t dst_offset, size_t count) {
+        if (!allocated_ || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot move values: memory is not allocated");
+        }
+        if (src_offset > size_ || count > size_ - src_offset || dst_offset > size_ || count > size_ - dst_offset) {
+            throw std::invalid_argument("Move range exceeds buffer size");
+        }
+        safeptr_detail::move_elements(ptr_ + src_offset, ptr_ + src_offset + count, ptr_ + dst_offset);
+    }
+
+    // Rotates left in place: the element at index k becomes the first one.
+    void rotate(size_t k) {
+        if (!allocated_ || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot rotate: memory is not allocated");
+        }
+        if (size_ == 0) {
+            return;
+        }
+        std::rotate(ptr_, ptr_ + k % size_, ptr_ + size_);
+    }
+
+    // Moves all elements k places towards the front and fills the vacated tail.
+    void shift_left(size_t k, const T& value = T()) {
+        if (!allocated_ || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot shift: memory is not allocated");
+        }
+        k = std::min(k, size_);
+        safeptr_detail::move_elements(ptr_ + k, ptr_ + size_, ptr_);
+        std::fill(ptr_ + size_ - k, ptr_ + size_, value);
+    }
+
+    // Moves all elements k places towards the back and fills the vacated head.
+    void shift_right(size_t k, const T& value = T()) {
+        if (!allocated_ || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot shift: memory is not allocated");
+        }
+        k = std::min(k, size_);
+        safeptr_detail::move_elements(ptr_, ptr_ + size_ - k, ptr_ + k);
+        std::fill(ptr_, ptr_ + k, value);
+    }
+
+    SAFEPTR_CONSTEXPR void get_values(const T* src_begin, const T* src_end, T* dst_begin) const {
         if (!allocated_ || ptr_ == nullptr) {
             throw std::runtime_error("Cannot get values: memory is not allocated");
         }
@@ -193,23 +625,47 @@ public:
         }
 
         size_t count = src_end - src_begin;
-        std::copy(src_begin, src_end, dst_begin);
+        safeptr_detail::copy_elements(src_begin, src_end, dst_begin);
     }
 
-    void get_values(T* dst_begin) const {
+    SAFEPTR_CONSTEXPR void get_values(T* dst_begin) const {
         get_values(begin(), end(), dst_begin);
     }
 
-    SafePointer<T>& operator=(const SafePointer<T>& other) {
+    SAFEPTR_CONSTEXPR SafePointer<T>& operator=(const SafePointer<T>& other) {
         if (this == &other) {
             return *this;
         }
         deallocate();
         allocate(other.size_);
-        std::copy(other.ptr_, other.ptr_ + other.size_, ptr_);
+        safeptr_detail::copy_elements<Mutable>(other.ptr_, other.ptr_ + other.size_, const_cast<Mutable*>(ptr_));
         return *this;
     }
 
+    // Evaluates an elementwise expression (see safeptr_expr.hpp) in one pass.
+    template <typename E, typename = typename E::safeptr_expression_tag>
+    SafePointer<T>& operator=(const E& expr) {
+        expr.evaluate_into(*this);
+        return *this;
+    }
+
+    SAFEPTR_CONSTEXPR SafePointer<T>& operator=(SafePointer<T>&& other) noexcept {
+        move(std::move(other));
+        return *this;
+    }
+
+    // Non-owning view over existing storage, such as a constexpr table in .rodata
+    // (use SafePointer<const T> for read-only data). It is never freed and cannot grow;
+    // copies and clones are ordinary owning buffers.
+    static SAFEPTR_CONSTEXPR SafePointer<T> view(T* data, size_t size) {
+        SafePointer<T> sptr;
+        sptr.ptr_ = data;
+        sptr.allocated_ = (data != nullptr);
+        sptr.owning_ = false;
+        sptr.size_ = data ? size : 0;
+        return sptr;
+    }
+
     // SafePointer(const SafePointer&) = delete;
     // SafePointer& operator=(const SafePointer&) = delete;
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+// Standard-library allocator over a SafeBackend, so containers draw from the same
+// pools and arenas as SafePointers (and show up in the same traces and statistics):
+//
+//     PoolBackend pool;
+//     std::vector<int, SafeAllocator<int>> v{SafeAllocator<int>(&pool)};
+//
+// Allocators compare equal when they share a backend and propagate with the
+// container on copy, move and swap.
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "safeptr.hpp"
+
+template <typename T>
+class SafeAllocator
+{
+private:
+    SafeBackend* backend_;
+
+    template <typename U>
+    friend class SafeAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    // nullptr binds SafeBackend::get_default() at construction: the calling thread's
+    // default (e.g. an active SafeTagScope's tag) if set, else the process default.
+    SafeAllocator(SafeBackend* backend = nullptr) noexcept
+        : backend_(backend ? backend : &SafeBackend::get_default()) {}
+
+    template <typename U>
+    SafeAllocator(const SafeAllocator<U>& other) noexcept : backend_(other.backend_) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = backend_->allocate(n * sizeof(T), alignof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept { backend_->deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+    SafeBackend* backend() const noexcept { return backend_; }
+
+    template <typename U>
+    bool operator==(const SafeAllocator<U>& other) const noexcept {
+        return backend_ == other.backend_;
+    }
+
+    template <typename U>
+    bool operator!=(const SafeAllocator<U>& other) const noexcept {
+        return backend_ != other.backend_;
+    }
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+// Bump-pointer arena backend. Blocks are carved from chunks obtained upstream and
+// are not reused individually: deallocate() only rolls back the most recent block,
+// and reallocate() grows that block in place while its chunk has room. Everything
+// is returned at once by reset() or destruction. Suits request-scoped buffers.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "safeptr.hpp"
+
+class ArenaBackend : public SafeBackend
+{
+private:
+    struct Chunk {
+        char* data;
+        size_t bytes;
+    };
+
+    SafeBackend* upstream_;
+    size_t chunk_bytes_;
+    std::mutex mutex_;
+    std::vector<Chunk> chunks_;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    char* last_ = nullptr;  // most recent block, the only one that can shrink or grow
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+
+    static char* align_up(char* p, size_t align) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+        return p + ((align - addr % align) % align);
+    }
+
+    bool fits(size_t bytes, size_t align) const {
+        return cur_ && align_up(cur_, align) <= end_ && bytes <= static_cast<size_t>(end_ - align_up(cur_, align));
+    }
+
+public:
+    explicit ArenaBackend(size_t chunk_bytes = 1 << 20, SafeBackend* upstream = nullptr)
+        : upstream_(upstream ? upstream : &MallocBackend::instance()), chunk_bytes_(chunk_bytes) {}
+
+    ~ArenaBackend() override { reset(); }
+
+    ArenaBackend(const ArenaBackend&) = delete;
+    ArenaBackend& operator=(const ArenaBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!fits(bytes, align)) {
+            size_t chunk_bytes = std::max(chunk_bytes_, bytes + align);
+            char* chunk = static_cast<char*>(upstream_->allocate(chunk_bytes, alignof(std::max_align_t)));
+            if (!chunk) {
+                return nullptr;
+            }
+            chunks_.push_back({chunk, chunk_bytes});
+            reserved_ += chunk_bytes;
+            cur_ = chunk;
+            end_ = chunk + chunk_bytes;
+        }
+        char* block = align_up(cur_, align);
+        used_ += bytes;
+        cur_ = block + bytes;
+        last_ = block;
+        return block;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ptr == last_) {
+            cur_ = last_;
+            last_ = nullptr;
+        }
+        used_ -= std::min(used_, bytes);
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ptr && ptr == last_ && new_bytes <= static_cast<size_t>(end_ - last_)) {
+                used_ += new_bytes;
+                used_ -= std::min(used_, old_bytes);
+                cur_ = last_ + new_bytes;
+                return ptr;
+            }
+        }
+        return SafeBackend::reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    // Returns every chunk upstream; outstanding blocks become invalid.
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Chunk& chunk : chunks_) {
+            upstream_->deallocate(chunk.data, chunk.bytes, alignof(std::max_align_t));
+        }
+        chunks_.clear();
+        cur_ = end_ = last_ = nullptr;
+        used_ = 0;
+        reserved_ = 0;
+    }
+
+    size_t used() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return used_;
+    }
+
+    size_t reserved() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reserved_;
+    }
+};
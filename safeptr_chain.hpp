@@ -0,0 +1,205 @@
+#pragma once
+
+// Scatter-gather buffer chain: an ordered list of byte ranges (headers, payload
+// segments, ...) written to a file descriptor with one writev/pwritev call per
+// IOV_MAX segments instead of first being concatenated into one buffer. Appending
+// or prepending never copies data: a SafePointer moved into the chain is owned by
+// it, while a span stays owned by the caller and must outlive the write.
+// Written bytes are consumed from the front, so a partial write (full pipe or
+// socket, signal, non-blocking descriptor) simply leaves the rest queued. POSIX only.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "safeptr.hpp"
+
+class SafeBufferChain
+{
+private:
+    struct Segment {
+        const unsigned char* data;
+        size_t size;
+        std::shared_ptr<void> owner;  // keeps an adopted SafePointer alive; null for spans
+    };
+
+    std::deque<Segment> segments_;
+    size_t size_ = 0;
+
+    static int iov_max() {
+#if defined(IOV_MAX)
+        return IOV_MAX;
+#else
+        long max = sysconf(_SC_IOV_MAX);
+        return max > 0 ? static_cast<int>(max) : 16;
+#endif
+    }
+
+    template <typename T>
+    static Segment adopt(SafePointer<T>&& sptr) {
+        if (!sptr.is_allocated() || sptr.get() == nullptr) {
+            throw std::runtime_error("Cannot chain an unallocated SafePointer");
+        }
+        auto owner = std::make_shared<SafePointer<T>>(std::move(sptr));
+        return {reinterpret_cast<const unsigned char*>(owner->get()), owner->size() * sizeof(T), owner};
+    }
+
+    int fill_iov(std::vector<struct iovec>& iov) const {
+        iov.clear();
+        int limit = iov_max();
+        for (const Segment& s : segments_) {
+            if (static_cast<int>(iov.size()) == limit) {
+                break;
+            }
+            iov.push_back({const_cast<unsigned char*>(s.data), s.size});
+        }
+        return static_cast<int>(iov.size());
+    }
+
+    static std::runtime_error error(const char* call) {
+        return std::runtime_error(std::string(call) + " failed: " + strerror(errno));
+    }
+
+public:
+    template <typename T>
+    void append(SafePointer<T>&& sptr) {
+        Segment s = adopt(std::move(sptr));
+        size_ += s.size;
+        segments_.push_back(std::move(s));
+    }
+
+    template <typename T>
+    void prepend(SafePointer<T>&& sptr) {
+        Segment s = adopt(std::move(sptr));
+        size_ += s.size;
+        segments_.push_front(std::move(s));
+    }
+
+    void append(const void* data, size_t bytes) {
+        if (bytes > 0) {
+            segments_.push_back({static_cast<const unsigned char*>(data), bytes, nullptr});
+            size_ += bytes;
+        }
+    }
+
+    void prepend(const void* data, size_t bytes) {
+        if (bytes > 0) {
+            segments_.push_front({static_cast<const unsigned char*>(data), bytes, nullptr});
+            size_ += bytes;
+        }
+    }
+
+    // Moves all of other's segments to the end of this chain.
+    void append(SafeBufferChain&& other) {
+        if (&other == this) {
+            return;
+        }
+        for (Segment& s : other.segments_) {
+            segments_.push_back(std::move(s));
+        }
+        size_ += other.size_;
+        other.clear();
+    }
+
+    size_t size() const { return size_; }
+    size_t segments() const { return segments_.size(); }
+    bool empty() const { return size_ == 0; }
+
+    void clear() {
+        segments_.clear();
+        size_ = 0;
+    }
+
+    // Drops the first n bytes, releasing segments that are fully consumed.
+    void consume(size_t n) {
+        if (n > size_) {
+            throw std::invalid_argument("Cannot consume more bytes than the chain holds");
+        }
+        size_ -= n;
+        while (n > 0) {
+            Segment& s = segments_.front();
+            if (n < s.size) {
+                s.data += n;
+                s.size -= n;
+                return;
+            }
+            n -= s.size;
+            segments_.pop_front();
+        }
+    }
+
+    // One writev attempt (retried on EINTR). Returns the bytes written and consumed;
+    // 0 when a non-blocking descriptor would block. Throws on other errors.
+    size_t write_some(int fd) {
+        if (segments_.empty()) {
+            return 0;
+        }
+        std::vector<struct iovec> iov;
+        int count = fill_iov(iov);
+        ssize_t written;
+        do {
+            written = writev(fd, iov.data(), count);
+        } while (written < 0 && errno == EINTR);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            throw error("writev");
+        }
+        consume(static_cast<size_t>(written));
+        return static_cast<size_t>(written);
+    }
+
+    // Writes the whole chain, continuing after partial writes. The descriptor must be blocking.
+    void write_all(int fd) {
+        while (!segments_.empty()) {
+            if (write_some(fd) == 0) {
+                throw std::runtime_error("writev made no progress");
+            }
+        }
+    }
+
+    // Writes the whole chain at offset without moving the file position.
+    void write_all_at(int fd, off_t offset) {
+        std::vector<struct iovec> iov;
+        while (!segments_.empty()) {
+            ssize_t written;
+#if defined(__linux__) || defined(__FreeBSD__)
+            int count = fill_iov(iov);
+            do {
+                written = pwritev(fd, iov.data(), count, offset);
+            } while (written < 0 && errno == EINTR);
+            if (written < 0) {
+                throw error("pwritev");
+            }
+#else
+            const Segment& s = segments_.front();
+            do {
+                written = pwrite(fd, s.data, s.size, offset);
+            } while (written < 0 && errno == EINTR);
+            if (written < 0) {
+                throw error("pwrite");
+            }
+#endif
+            if (written == 0) {
+                throw std::runtime_error("pwritev made no progress");
+            }
+            consume(static_cast<size_t>(written));
+            offset += written;
+        }
+    }
+};
+
+#endif
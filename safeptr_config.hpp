@@ -0,0 +1,23 @@
+#pragma once
+
+#include <type_traits>
+
+// With C++20 transient allocation the allocation, fill and copy paths of
+// SafePointer also run in constant evaluation; storage then comes from
+// std::allocator and must be released before the evaluation ends.
+// Define SAFEPTR_CONSTEXPR_ALLOC to 0 to opt out.
+#ifndef SAFEPTR_CONSTEXPR_ALLOC
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define SAFEPTR_CONSTEXPR_ALLOC 1
+#else
+#define SAFEPTR_CONSTEXPR_ALLOC 0
+#endif
+#endif
+
+#if SAFEPTR_CONSTEXPR_ALLOC
+#define SAFEPTR_CONSTEXPR constexpr
+#define SAFEPTR_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define SAFEPTR_CONSTEXPR
+#define SAFEPTR_CONSTANT_EVALUATED() false
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+// Element conversion kernels used by SafePointer::convert_to/convert_into.
+// Loops are branch-free selects over contiguous arrays so the compiler turns them
+// into packed conversions (cvtps2pd, packssdw, roundps/cvtps2dq, ...).
+// Other element types plug in by specialising SafeConvert.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace safeptr_detail {
+
+// Saturating integer narrowing/sign change.
+template <typename To, typename From>
+To saturate_int(From v) {
+    if constexpr (std::is_signed<From>::value) {
+        if (v < 0) {
+            if constexpr (!std::is_signed<To>::value) {
+                return 0;
+            } else {
+                return static_cast<intmax_t>(v) < static_cast<intmax_t>(std::numeric_limits<To>::min())
+                           ? std::numeric_limits<To>::min()
+                           : static_cast<To>(v);
+            }
+        }
+    }
+    return static_cast<uintmax_t>(v) > static_cast<uintmax_t>(std::numeric_limits<To>::max())
+               ? std::numeric_limits<To>::max()
+               : static_cast<To>(v);
+}
+
+// Largest F not above the integer maximum; F(max) itself may round up past it.
+template <typename F, typename I>
+F float_int_max() {
+    F hi = static_cast<F>(std::numeric_limits<I>::max());
+    return static_cast<long double>(hi) > static_cast<long double>(std::numeric_limits<I>::max())
+               ? std::nextafter(hi, F(0))
+               : hi;
+}
+
+// Rounds to nearest and saturates; NaN becomes 0.
+template <typename I, typename F>
+void float_to_int(const F* src, I* dst, size_t n, F scale) {
+    const F lo = static_cast<F>(std::numeric_limits<I>::min());
+    const F hi = float_int_max<F, I>();
+    for (size_t i = 0; i < n; ++i) {
+        F v = std::nearbyint(src[i] * scale);
+        v = v == v ? v : F(0);  // before the cast: converting NaN is undefined
+        dst[i] = v > hi ? std::numeric_limits<I>::max() : static_cast<I>(v < lo ? lo : v);
+    }
+}
+
+}  // namespace safeptr_detail
+
+template <typename From, typename To, typename = void>
+struct SafeConvert
+{
+    static void run(const From* src, To* dst, size_t n, double scale) {
+        if constexpr (std::is_floating_point<To>::value) {
+            // Scale in the wider of the two float types so float->float stays single precision.
+            using W = typename std::conditional<std::is_floating_point<From>::value && (sizeof(From) > sizeof(To)),
+                                                From, To>::type;
+            if (scale == 1.0) {
+                for (size_t i = 0; i < n; ++i) {
+                    dst[i] = static_cast<To>(src[i]);
+                }
+            } else {
+                const W s = static_cast<W>(scale);
+                for (size_t i = 0; i < n; ++i) {
+                    dst[i] = static_cast<To>(static_cast<W>(src[i]) * s);
+                }
+            }
+        } else if constexpr (std::is_floating_point<From>::value) {
+            safeptr_detail::float_to_int(src, dst, n, static_cast<From>(scale));
+        } else if (scale != 1.0) {
+            // Scaled integer conversion goes through double.
+            for (size_t i = 0; i < n; ++i) {
+                double v = std::nearbyint(static_cast<double>(src[i]) * scale);
+                safeptr_detail::float_to_int(&v, dst + i, 1, 1.0);
+            }
+        } else if constexpr ((std::is_signed<From>::value == std::is_signed<To>::value && sizeof(From) <= sizeof(To)) ||
+                             (!std::is_signed<From>::value && std::is_signed<To>::value && sizeof(From) < sizeof(To))) {
+            for (size_t i = 0; i < n; ++i) {
+                dst[i] = static_cast<To>(src[i]);  // widening
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                dst[i] = safeptr_detail::saturate_int<To>(src[i]);
+            }
+        }
+    }
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+// Size-tiered copy engine behind SafePointer's clone/copy/set_values/get_values
+// and assignment for trivially copyable elements:
+//   - up to 64 bytes: inlined fixed-size moves (two possibly overlapping halves),
+//   - medium: `rep movsb` on x86-64 CPUs with ERMS, memcpy elsewhere,
+//   - beyond nontemporal_min: streaming stores that bypass the cache, optionally
+//     split over the shared WorkStealingPool.
+// Thresholds are set up on first use from the last-level cache size (sysconf) and
+// the CPU's ERMS flag (cpuid), which costs microseconds. Measuring the real
+// crossover points takes a few hundred milliseconds and 512 MiB, too much to do
+// implicitly, so that is left to an explicit tune() call, e.g. at startup.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#define SAFEPTR_COPY_X86 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "safeptr_config.hpp"
+#include "safeptr_workers.hpp"
+
+struct SafeCopyConfig
+{
+    size_t rep_movsb_min = 2048;        // 0 disables rep movsb
+    size_t nontemporal_min = 8 << 20;
+    size_t parallel_min = 64 << 20;     // only with threads > 1
+    unsigned threads = 1;               // parallel copies use up to this many pool threads
+};
+
+namespace safeptr_detail {
+
+inline void copy_small(unsigned char* d, const unsigned char* s, size_t n) {
+    if (n >= 32) {
+        memcpy(d, s, 32);
+        memcpy(d + n - 32, s + n - 32, 32);
+    } else if (n >= 16) {
+        memcpy(d, s, 16);
+        memcpy(d + n - 16, s + n - 16, 16);
+    } else if (n >= 8) {
+        memcpy(d, s, 8);
+        memcpy(d + n - 8, s + n - 8, 8);
+    } else if (n >= 4) {
+        memcpy(d, s, 4);
+        memcpy(d + n - 4, s + n - 4, 4);
+    } else if (n > 0) {
+        d[0] = s[0];
+        d[n / 2] = s[n / 2];
+        d[n - 1] = s[n - 1];
+    }
+}
+
+inline bool cpu_has_erms() {
+#if SAFEPTR_COPY_X86 && defined(__GNUC__)
+    unsigned a, b, c, d;
+    return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (b & (1u << 9));
+#else
+    return false;
+#endif
+}
+
+inline void copy_rep_movsb(unsigned char* d, const unsigned char* s, size_t n) {
+#if SAFEPTR_COPY_X86 && defined(__GNUC__)
+    __asm__ __volatile__("rep movsb" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+#else
+    memcpy(d, s, n);
+#endif
+}
+
+inline void copy_nontemporal(unsigned char* d, const unsigned char* s, size_t n) {
+#if SAFEPTR_COPY_X86
+    size_t head = (0 - reinterpret_cast<uintptr_t>(d)) & 31;
+    if (head > n) {
+        head = n;
+    }
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+    for (; n >= 128; n -= 128, d += 128, s += 128) {
+#if defined(__AVX__)
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), e);
+#else
+        for (size_t k = 0; k < 128; k += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + k));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + k), v);
+        }
+#endif
+    }
+    _mm_sfence();
+    memcpy(d, s, n);
+#else
+    memcpy(d, s, n);
+#endif
+}
+
+}  // namespace safeptr_detail
+
+class SafeCopyEngine
+{
+private:
+    // Fields are read independently by concurrent copies; any mix of old and new
+    // values during set_config() is still a valid configuration.
+    struct Thresholds {
+        std::atomic<size_t> rep_movsb_min{0};
+        std::atomic<size_t> nontemporal_min{0};
+        std::atomic<size_t> parallel_min{0};
+        std::atomic<unsigned> threads{1};
+
+        void store(const SafeCopyConfig& c) {
+            rep_movsb_min.store(c.rep_movsb_min, std::memory_order_relaxed);
+            nontemporal_min.store(c.nontemporal_min, std::memory_order_relaxed);
+            parallel_min.store(c.parallel_min, std::memory_order_relaxed);
+            threads.store(c.threads, std::memory_order_relaxed);
+        }
+    };
+
+    static Thresholds& thresholds() {
+        static Thresholds thresholds;
+        static std::once_flag detected;
+        std::call_once(detected, [] { thresholds.store(detect()); });
+        return thresholds;
+    }
+
+    static SafeCopyConfig detect() {
+        SafeCopyConfig config;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (llc > 0) {
+            // Past ~3/4 of the LLC a copy would evict its own working set anyway.
+            config.nontemporal_min = static_cast<size_t>(llc) / 4 * 3;
+        }
+#endif
+        if (!safeptr_detail::cpu_has_erms()) {
+            config.rep_movsb_min = 0;
+        }
+        return config;
+    }
+
+    static void copy_huge(unsigned char* d, const unsigned char* s, size_t n, unsigned threads) {
+        if (threads <= 1) {
+            safeptr_detail::copy_nontemporal(d, s, n);
+            return;
+        }
+        // Page-granular ranges, about two per thread so stealing evens out the tail.
+        size_t pages = (n + 4095) / 4096;
+        size_t grain = std::max<size_t>(1, (pages + 2 * threads - 1) / (2 * threads));
+        WorkStealingPool::instance().parallel_for(0, pages, grain, [d, s, n](size_t lo, size_t hi) {
+            size_t off = lo * 4096;
+            safeptr_detail::copy_nontemporal(d + off, s + off, std::min(hi * 4096, n) - off);
+        });
+    }
+
+    template <typename F>
+    static double seconds(F f, int reps) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; ++i) {
+            f();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    // Current thresholds in bytes.
+    static SafeCopyConfig config() {
+        Thresholds& t = thresholds();
+        SafeCopyConfig c;
+        c.rep_movsb_min = t.rep_movsb_min.load(std::memory_order_relaxed);
+        c.nontemporal_min = t.nontemporal_min.load(std::memory_order_relaxed);
+        c.parallel_min = t.parallel_min.load(std::memory_order_relaxed);
+        c.threads = t.threads.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    // Replaces the thresholds; safe while other threads copy.
+    static void set_config(const SafeCopyConfig& config) { thresholds().store(config); }
+
+    // Copies n bytes between non-overlapping buffers.
+    static void copy(void* dst, const void* src, size_t n) {
+        unsigned char* d = static_cast<unsigned char*>(dst);
+        const unsigned char* s = static_cast<const unsigned char*>(src);
+        if (n <= 64) {
+            safeptr_detail::copy_small(d, s, n);
+            return;
+        }
+        Thresholds& t = thresholds();
+        size_t rep_movsb_min = t.rep_movsb_min.load(std::memory_order_relaxed);
+        if (n >= t.nontemporal_min.load(std::memory_order_relaxed)) {
+            bool parallel = n >= t.parallel_min.load(std::memory_order_relaxed);
+            copy_huge(d, s, n, parallel ? t.threads.load(std::memory_order_relaxed) : 1);
+        } else if (rep_movsb_min && n >= rep_movsb_min) {
+            safeptr_detail::copy_rep_movsb(d, s, n);
+        } else {
+            memcpy(d, s, n);
+        }
+    }
+
+    // Measures the crossover points on this machine and installs them with set_config().
+    // Takes a few hundred milliseconds and touches up to 2 x 256 MiB.
+    static void tune() {
+        SafeCopyConfig c = config();
+        std::vector<unsigned char> src(256 << 20, 1), dst(256 << 20);
+        c.nontemporal_min = SIZE_MAX;
+        for (size_t n = 1 << 20; n <= src.size(); n *= 2) {
+            int reps = static_cast<int>(std::max<size_t>(1, (64 << 20) / n));
+            double cached = seconds([&] { memcpy(dst.data(), src.data(), n); }, reps);
+            double streamed = seconds([&] { safeptr_detail::copy_nontemporal(dst.data(), src.data(), n); }, reps);
+            if (streamed < cached) {
+                c.nontemporal_min = n;
+                break;
+            }
+        }
+        if (c.rep_movsb_min) {
+            c.rep_movsb_min = 0;
+            for (size_t n = 256; n <= (256 << 10); n *= 2) {
+                int reps = static_cast<int>((16 << 20) / n);
+                double libc = seconds([&] { memcpy(dst.data(), src.data(), n); }, reps);
+                double movsb = seconds([&] { safeptr_detail::copy_rep_movsb(dst.data(), src.data(), n); }, reps);
+                if (movsb <= libc) {
+                    c.rep_movsb_min = n;
+                    break;
+                }
+            }
+        }
+        set_config(c);
+    }
+};
+
+namespace safeptr_detail {
+
+// Element copy used by SafePointer; engine for trivially copyable T, std::copy otherwise
+// and during constant evaluation.
+template <typename T>
+SAFEPTR_CONSTEXPR void copy_elements(const T* src_begin, const T* src_end, T* dst_begin) {
+    if (SAFEPTR_CONSTANT_EVALUATED()) {
+        std::copy(src_begin, src_end, dst_begin);
+    } else if constexpr (std::is_trivially_copyable<T>::value) {
+        SafeCopyEngine::copy(dst_begin, src_begin, (src_end - src_begin) * sizeof(T));
+    } else {
+        std::copy(src_begin, src_end, dst_begin);
+    }
+}
+
+// Overlap-safe element move: memmove for trivially copyable T, otherwise a
+// forward or backward element-wise move depending on direction.
+template <typename T>
+void move_elements(const T* src_begin, const T* src_end, T* dst_begin) {
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        memmove(dst_begin, src_begin, (src_end - src_begin) * sizeof(T));
+    } else {
+        T* src = const_cast<T*>(src_begin);
+        if (dst_begin < src) {
+            std::move(src, const_cast<T*>(src_end), dst_begin);
+        } else {
+            std::move_backward(src, const_cast<T*>(src_end), dst_begin + (src_end - src_begin));
+        }
+    }
+}
+
+}  // namespace safeptr_detail
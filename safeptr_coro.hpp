@@ -0,0 +1,301 @@
+#pragma once
+
+// C++20 coroutine support: chunked traversal of large SafePointers and
+// asynchronous clone/fill/copy that yield to an executor between chunks.
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "safeptr.hpp"
+
+namespace safeptr_detail {
+
+constexpr size_t default_async_chunk_bytes = 1 << 20;
+
+template <typename T>
+size_t chunk_elements(size_t chunk_bytes) {
+    return std::max<size_t>(1, chunk_bytes / sizeof(T));
+}
+
+}  // namespace safeptr_detail
+
+// Lazy single-pass generator, usable in range-for.
+template <typename T>
+class SafeGenerator
+{
+public:
+    struct promise_type {
+        std::optional<T> current_;
+        std::exception_ptr error_;
+
+        SafeGenerator get_return_object() {
+            return SafeGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) {
+            current_ = std::move(value);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error_ = std::current_exception(); }
+    };
+
+    class iterator
+    {
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    public:
+        explicit iterator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        const T& operator*() const { return *handle_.promise().current_; }
+        iterator& operator++() {
+            advance(handle_);
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const { return !handle_ || handle_.done(); }
+    };
+
+    SafeGenerator(SafeGenerator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    SafeGenerator(const SafeGenerator&) = delete;
+    SafeGenerator& operator=(const SafeGenerator&) = delete;
+    ~SafeGenerator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    iterator begin() {
+        advance(handle_);
+        return iterator(handle_);
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit SafeGenerator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    static void advance(std::coroutine_handle<promise_type> handle) {
+        handle.resume();
+        if (handle.promise().error_) {
+            std::rethrow_exception(handle.promise().error_);
+        }
+    }
+};
+
+// Yields the buffer as consecutive spans of at most chunk_size elements.
+template <typename T>
+SafeGenerator<std::span<T>> chunked(SafePointer<T>& sptr, size_t chunk_size) {
+    if (!sptr.is_allocated() || sptr.get() == nullptr) {
+        throw std::runtime_error("Cannot iterate: memory is not allocated");
+    }
+    if (chunk_size == 0) {
+        throw std::invalid_argument("Chunk size cannot be 0");
+    }
+    for (size_t offset = 0; offset < sptr.size(); offset += chunk_size) {
+        co_yield std::span<T>(sptr.get() + offset, std::min(chunk_size, sptr.size() - offset));
+    }
+}
+
+template <typename T>
+SafeGenerator<std::span<const T>> chunked(const SafePointer<T>& sptr, size_t chunk_size) {
+    if (!sptr.is_allocated() || sptr.get() == nullptr) {
+        throw std::runtime_error("Cannot iterate: memory is not allocated");
+    }
+    if (chunk_size == 0) {
+        throw std::invalid_argument("Chunk size cannot be 0");
+    }
+    for (size_t offset = 0; offset < sptr.size(); offset += chunk_size) {
+        co_yield std::span<const T>(sptr.get() + offset, std::min(chunk_size, sptr.size() - offset));
+    }
+}
+
+namespace safeptr_detail {
+
+template <typename T>
+struct task_result {
+    std::optional<T> value_;
+    void return_value(T value) { value_.emplace(std::move(value)); }
+    T take() { return std::move(*value_); }
+};
+
+template <>
+struct task_result<void> {
+    void return_void() {}
+    void take() {}
+};
+
+}  // namespace safeptr_detail
+
+// Lazily started coroutine task. Either co_await it from another coroutine,
+// or start() it from plain code and poll done() while the executor runs.
+template <typename T = void>
+class SafeTask
+{
+public:
+    struct promise_type : safeptr_detail::task_result<T> {
+        std::coroutine_handle<> continuation_;
+        std::exception_ptr error_;
+
+        SafeTask get_return_object() {
+            return SafeTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                std::coroutine_handle<> next = handle.promise().continuation_;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        final_awaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { error_ = std::current_exception(); }
+    };
+
+    SafeTask(SafeTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    SafeTask(const SafeTask&) = delete;
+    SafeTask& operator=(const SafeTask&) = delete;
+    ~SafeTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void start() {
+        if (!handle_) {
+            throw std::runtime_error("Cannot start an empty task");
+        }
+        handle_.resume();
+    }
+
+    bool done() const { return handle_ && handle_.done(); }
+
+    // Result of a finished task; rethrows the exception it ended with.
+    T get() {
+        if (!done()) {
+            throw std::runtime_error("Task has not finished");
+        }
+        if (handle_.promise().error_) {
+            std::rethrow_exception(handle_.promise().error_);
+        }
+        return handle_.promise().take();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation_ = awaiting;
+        return handle_;
+    }
+    T await_resume() { return get(); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit SafeTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+};
+
+// Minimal single-threaded executor: a FIFO of resumable coroutines.
+// Any type with post(std::coroutine_handle<>) can be used in its place.
+class SafeEventLoop
+{
+private:
+    std::deque<std::coroutine_handle<>> ready_;
+public:
+    void post(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    bool run_one() {
+        if (ready_.empty()) {
+            return false;
+        }
+        std::coroutine_handle<> handle = ready_.front();
+        ready_.pop_front();
+        handle.resume();
+        return true;
+    }
+
+    void run() {
+        while (run_one()) {
+        }
+    }
+};
+
+// Suspends the current coroutine and queues it at the back of the executor.
+template <typename Executor>
+auto reschedule(Executor& executor) {
+    struct awaiter {
+        Executor& executor_;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor_.post(handle); }
+        void await_resume() const noexcept {}
+    };
+    return awaiter{executor};
+}
+
+template <typename Executor, typename T>
+SafeTask<SafePointer<T>> async_clone(Executor& executor, const SafePointer<T>& src,
+                                     size_t chunk_bytes = safeptr_detail::default_async_chunk_bytes) {
+    if (!src.is_allocated() || src.get() == nullptr) {
+        throw std::runtime_error("Cannot clone an unallocated SafePointer");
+    }
+    SafePointer<T> out;
+    out.allocate(src.size());
+    size_t step = safeptr_detail::chunk_elements<T>(chunk_bytes);
+    for (size_t offset = 0; offset < src.size(); offset += step) {
+        size_t count = std::min(step, src.size() - offset);
+        safeptr_detail::copy_elements<T>(src.get() + offset, src.get() + offset + count, out.get() + offset);
+        if (offset + count < src.size()) {
+            co_await reschedule(executor);
+        }
+    }
+    co_return out;
+}
+
+template <typename Executor, typename T>
+SafeTask<> async_fill(Executor& executor, SafePointer<T>& dst, T value,
+                      size_t chunk_bytes = safeptr_detail::default_async_chunk_bytes) {
+    if (!dst.is_allocated() || dst.get() == nullptr) {
+        throw std::runtime_error("Cannot fill: memory is not allocated");
+    }
+    size_t step = safeptr_detail::chunk_elements<T>(chunk_bytes);
+    for (size_t offset = 0; offset < dst.size(); offset += step) {
+        size_t count = std::min(step, dst.size() - offset);
+        std::fill(dst.get() + offset, dst.get() + offset + count, value);
+        if (offset + count < dst.size()) {
+            co_await reschedule(executor);
+        }
+    }
+}
+
+// Asynchronous counterpart of dst.copy(src, size).
+template <typename Executor, typename T>
+SafeTask<> async_copy(Executor& executor, SafePointer<T>& dst, const SafePointer<T>& src, size_t size,
+                      size_t chunk_bytes = safeptr_detail::default_async_chunk_bytes) {
+    if (!src.is_allocated()) {
+        throw std::runtime_error("Cannot copy from an unallocated SafePointer");
+    }
+    if (size > src.size()) {
+        throw std::invalid_argument("Copy size exceeds source size");
+    }
+    dst.allocate(size);
+    size_t step = safeptr_detail::chunk_elements<T>(chunk_bytes);
+    for (size_t offset = 0; offset < size; offset += step) {
+        size_t count = std::min(step, size - offset);
+        safeptr_detail::copy_elements<T>(src.get() + offset, src.get() + offset + count, dst.get() + offset);
+        if (offset + count < size) {
+            co_await reschedule(executor);
+        }
+    }
+}
+
+#endif
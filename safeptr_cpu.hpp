@@ -0,0 +1,40 @@
+#pragma once
+
+// Number of the CPU the calling thread runs on, shared by the per-CPU counters
+// (safeptr_tags.hpp) and caches (safeptr_percpu.hpp). It is read from the rseq
+// area that glibc 2.35+ registers for every thread (a plain load, no syscall),
+// else from sched_getcpu(). The thread may be migrated right after the read, so
+// callers use it to pick a likely uncontended slot, never for exclusion.
+
+#if defined(__linux__)
+#include <sched.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35)) && defined(__has_include)
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define SAFEPTR_HAS_RSEQ 1
+#endif
+#endif
+#endif
+
+namespace safeptr_detail {
+
+// CPU the calling thread runs on, or -1 when the platform cannot tell.
+inline int current_cpu_id() {
+#if defined(SAFEPTR_HAS_RSEQ)
+    if (__rseq_size > 0) {
+        const struct rseq* area = reinterpret_cast<const struct rseq*>(
+            static_cast<const char*>(__builtin_thread_pointer()) + __rseq_offset);
+        int cpu = static_cast<int>(__atomic_load_n(&area->cpu_id, __ATOMIC_RELAXED));
+        if (cpu >= 0) {
+            return cpu;
+        }
+    }
+#endif
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+}  // namespace safeptr_detail
@@ -0,0 +1,131 @@
+#pragma once
+
+// Deferred-free backend decorator. Deallocation of large blocks (at least
+// min_bytes) only pushes the block onto a lock-free list, reusing the dead block's
+// first bytes as the list node, and returns; a background reclaimer thread hands
+// them to the upstream backend in batches, taking the munmap and TLB shootdown
+// cost of huge frees off latency-critical threads. Smaller blocks are freed inline.
+// The reclaimer runs every `interval`, or as soon as batch_bytes are pending.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "safeptr.hpp"
+
+struct SafeDeferredFreeOptions
+{
+    size_t min_bytes = 1 << 20;     // smaller blocks are freed on the calling thread
+    size_t batch_bytes = 64 << 20;  // pending bytes that wake the reclaimer early
+    std::chrono::milliseconds interval{10};
+};
+
+class DeferredFreeBackend : public SafeBackend
+{
+private:
+    // Written into the first bytes of a pending block with memcpy: upstreams such as
+    // ArenaBackend only guarantee the requested alignment, which may be below alignof(Node).
+    struct Node {
+        void* next;
+        size_t bytes;
+        size_t align;
+    };
+
+    SafeDeferredFreeOptions options_;
+    SafeBackend* upstream_;
+    std::atomic<void*> head_{nullptr};
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread reclaimer_;
+
+    size_t free_batch() {
+        void* block = head_.exchange(nullptr, std::memory_order_acquire);
+        size_t freed = 0;
+        while (block) {
+            Node node;
+            memcpy(&node, block, sizeof(Node));
+            upstream_->deallocate(block, node.bytes, node.align);
+            freed += node.bytes;
+            block = node.next;
+        }
+        pending_.fetch_sub(freed, std::memory_order_relaxed);
+        return freed;
+    }
+
+    void reclaimer_main() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_.load()) {
+            cv_.wait_for(lock, options_.interval, [this] {
+                return stop_.load() || pending_.load(std::memory_order_relaxed) >= options_.batch_bytes;
+            });
+            lock.unlock();
+            free_batch();
+            lock.lock();
+        }
+    }
+
+public:
+    explicit DeferredFreeBackend(const SafeDeferredFreeOptions& options = SafeDeferredFreeOptions(),
+                                 SafeBackend* upstream = nullptr)
+        : options_(options), upstream_(upstream ? upstream : &MallocBackend::instance()) {
+        if (options_.min_bytes < sizeof(Node)) {
+            throw std::invalid_argument("min_bytes must leave room for the free-list node");
+        }
+        reclaimer_ = std::thread(&DeferredFreeBackend::reclaimer_main, this);
+    }
+
+    // Stops the reclaimer and frees whatever is still pending.
+    ~DeferredFreeBackend() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_.store(true);
+        }
+        cv_.notify_one();
+        reclaimer_.join();
+        free_batch();
+    }
+
+    DeferredFreeBackend(const DeferredFreeBackend&) = delete;
+    DeferredFreeBackend& operator=(const DeferredFreeBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override { return upstream_->allocate(bytes, align); }
+
+    void* callocate(size_t bytes, size_t align) override { return upstream_->callocate(bytes, align); }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        return upstream_->reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (bytes < options_.min_bytes) {
+            upstream_->deallocate(ptr, bytes, align);
+            return;
+        }
+        // Counted before the push so the reclaimer never subtracts bytes not yet added.
+        size_t pending = pending_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        Node node{head_.load(std::memory_order_relaxed), bytes, align};
+        do {
+            memcpy(ptr, &node, sizeof(Node));
+        } while (!head_.compare_exchange_weak(node.next, ptr, std::memory_order_release, std::memory_order_relaxed));
+        if (pending >= options_.batch_bytes && pending - bytes < options_.batch_bytes) {
+            // Only the free that crosses the threshold pays for the wakeup. Taking the
+            // mutex orders it after a reclaimer that checked pending_ and is about to wait.
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cv_.notify_one();
+        }
+    }
+
+    void on_clone(const void* src, const void* dst, size_t bytes) override { upstream_->on_clone(src, dst, bytes); }
+
+    // Frees everything pending on the calling thread; returns the bytes released.
+    size_t drain() { return free_batch(); }
+
+    size_t pending_bytes() const { return pending_.load(std::memory_order_relaxed); }
+};
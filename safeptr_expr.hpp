@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "safeptr.hpp"
+#include "safeptr_parallel.hpp"
+
+// Lazily evaluated elementwise expressions over SafePointers.
+// `out = a * b + c` builds a tree of lightweight nodes and evaluates it in a single
+// loop on assignment, so no temporaries are allocated and each operand is read once.
+// Operands are referenced, not copied: they must outlive the expression.
+
+template <typename D>
+struct SafeExpr
+{
+    using safeptr_expression_tag = void;
+
+    const D& self() const { return static_cast<const D&>(*this); }
+
+    // Evaluates into out, (re)allocating it to the expression size like copy().
+    template <typename T>
+    void evaluate_into(SafePointer<T>& out) const {
+        size_t n = self().size();
+        if (!out.is_allocated() || out.size() != n) {
+            out.allocate(n);
+        }
+        evaluate_range(out.get(), 0, n);
+    }
+
+    template <typename T>
+    void evaluate_range(T* dst, size_t lo, size_t hi) const {
+        const D& e = self();
+        for (size_t i = lo; i < hi; ++i) {
+            dst[i] = static_cast<T>(e[i]);
+        }
+    }
+};
+
+template <typename T>
+class SafeTerminal : public SafeExpr<SafeTerminal<T>>
+{
+private:
+    const T* ptr_;
+    size_t size_;
+public:
+    static constexpr bool is_scalar = false;
+
+    explicit SafeTerminal(const SafePointer<T>& sptr) : ptr_(sptr.get()), size_(sptr.size()) {
+        if (!sptr.is_allocated() || ptr_ == nullptr) {
+            throw std::runtime_error("Cannot use an unallocated SafePointer in an expression");
+        }
+    }
+
+    size_t size() const { return size_; }
+    const T& operator[](size_t idx) const { return ptr_[idx]; }
+};
+
+template <typename T>
+class SafeScalar : public SafeExpr<SafeScalar<T>>
+{
+private:
+    T value_;
+public:
+    static constexpr bool is_scalar = true;
+
+    explicit SafeScalar(const T& value) : value_(value) {}
+
+    size_t size() const { return 0; }
+    const T& operator[](size_t) const { return value_; }
+};
+
+template <typename Op, typename E>
+class SafeUnaryExpr : public SafeExpr<SafeUnaryExpr<Op, E>>
+{
+private:
+    E operand_;
+public:
+    static constexpr bool is_scalar = E::is_scalar;
+
+    explicit SafeUnaryExpr(const E& operand) : operand_(operand) {}
+
+    size_t size() const { return operand_.size(); }
+    auto operator[](size_t idx) const { return Op()(operand_[idx]); }
+};
+
+template <typename Op, typename L, typename R>
+class SafeBinaryExpr : public SafeExpr<SafeBinaryExpr<Op, L, R>>
+{
+private:
+    L lhs_;
+    R rhs_;
+public:
+    static constexpr bool is_scalar = L::is_scalar && R::is_scalar;
+
+    SafeBinaryExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        if (!L::is_scalar && !R::is_scalar && lhs_.size() != rhs_.size()) {
+            throw std::invalid_argument("Expression operands differ in size");
+        }
+    }
+
+    size_t size() const { return L::is_scalar ? rhs_.size() : lhs_.size(); }
+    auto operator[](size_t idx) const { return Op()(lhs_[idx], rhs_[idx]); }
+};
+
+namespace safeptr_detail {
+
+struct expr_add { template <typename A, typename B> auto operator()(A a, B b) const { return a + b; } };
+struct expr_sub { template <typename A, typename B> auto operator()(A a, B b) const { return a - b; } };
+struct expr_mul { template <typename A, typename B> auto operator()(A a, B b) const { return a * b; } };
+struct expr_div { template <typename A, typename B> auto operator()(A a, B b) const { return a / b; } };
+// Written as selects rather than std::min/max so they lower to packed min/max instructions.
+struct expr_min { template <typename A, typename B> auto operator()(A a, B b) const { return b < a ? b : a; } };
+struct expr_max { template <typename A, typename B> auto operator()(A a, B b) const { return a < b ? b : a; } };
+struct expr_neg { template <typename A> auto operator()(A a) const { return -a; } };
+struct expr_abs { template <typename A> auto operator()(A a) const { return a < A(0) ? -a : a; } };
+
+// Maps an operand (SafePointer, expression node or arithmetic scalar) to its node type.
+template <typename X, typename = void>
+struct expr_operand {
+    static constexpr bool is_operand = false;
+    static constexpr bool is_array = false;
+};
+
+template <typename T>
+struct expr_operand<SafePointer<T>> {
+    static constexpr bool is_operand = true;
+    static constexpr bool is_array = true;
+    using type = SafeTerminal<T>;
+    static type wrap(const SafePointer<T>& sptr) { return type(sptr); }
+};
+
+template <typename X>
+struct expr_operand<X, typename std::enable_if<std::is_base_of<SafeExpr<X>, X>::value>::type> {
+    static constexpr bool is_operand = true;
+    static constexpr bool is_array = !X::is_scalar;
+    using type = X;
+    static const type& wrap(const X& expr) { return expr; }
+};
+
+template <typename X>
+struct expr_operand<X, typename std::enable_if<std::is_arithmetic<X>::value>::type> {
+    static constexpr bool is_operand = true;
+    static constexpr bool is_array = false;
+    using type = SafeScalar<X>;
+    static type wrap(const X& value) { return type(value); }
+};
+
+template <typename L, typename R>
+using binary_operands = std::integral_constant<bool,
+    expr_operand<L>::is_operand && expr_operand<R>::is_operand &&
+    (expr_operand<L>::is_array || expr_operand<R>::is_array)>;
+
+template <typename Op, typename L, typename R>
+using binary_result = typename std::enable_if<binary_operands<L, R>::value,
+    SafeBinaryExpr<Op, typename expr_operand<L>::type, typename expr_operand<R>::type>>::type;
+
+template <typename Op, typename E>
+using unary_result = typename std::enable_if<expr_operand<E>::is_array,
+    SafeUnaryExpr<Op, typename expr_operand<E>::type>>::type;
+
+template <typename Op, typename L, typename R>
+binary_result<Op, L, R> make_binary(const L& lhs, const R& rhs) {
+    return binary_result<Op, L, R>(expr_operand<L>::wrap(lhs), expr_operand<R>::wrap(rhs));
+}
+
+template <typename Op, typename E>
+unary_result<Op, E> make_unary(const E& operand) {
+    return unary_result<Op, E>(expr_operand<E>::wrap(operand));
+}
+
+}  // namespace safeptr_detail
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_add, L, R> operator+(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_add>(lhs, rhs);
+}
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_sub, L, R> operator-(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_sub>(lhs, rhs);
+}
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_mul, L, R> operator*(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_mul>(lhs, rhs);
+}
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_div, L, R> operator/(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_div>(lhs, rhs);
+}
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_min, L, R> min(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_min>(lhs, rhs);
+}
+
+template <typename L, typename R>
+safeptr_detail::binary_result<safeptr_detail::expr_max, L, R> max(const L& lhs, const R& rhs) {
+    return safeptr_detail::make_binary<safeptr_detail::expr_max>(lhs, rhs);
+}
+
+template <typename E>
+safeptr_detail::unary_result<safeptr_detail::expr_neg, E> operator-(const E& operand) {
+    return safeptr_detail::make_unary<safeptr_detail::expr_neg>(operand);
+}
+
+template <typename E>
+safeptr_detail::unary_result<safeptr_detail::expr_abs, E> abs(const E& operand) {
+    return safeptr_detail::make_unary<safeptr_detail::expr_abs>(operand);
+}
+
+// Evaluates expr into out on the work-stealing pool, one chunk per task.
+template <typename T, typename D>
+void parallel_assign(WorkStealingPool& pool, SafePointer<T>& out, const SafeExpr<D>& expr, size_t grain = 0) {
+    size_t n = expr.self().size();
+    if (!out.is_allocated() || out.size() != n) {
+        out.allocate(n);
+    }
+    T* dst = out.get();
+    pool.parallel_for(0, n, grain ? grain : safeptr_detail::default_grain<T>(),
+                      [dst, &expr](size_t lo, size_t hi) { expr.evaluate_range(dst, lo, hi); });
+}
+
+template <typename T, typename D>
+void parallel_assign(SafePointer<T>& out, const SafeExpr<D>& expr, size_t grain = 0) {
+    parallel_assign(WorkStealingPool::instance(), out, expr, grain);
+}
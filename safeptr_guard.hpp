@@ -0,0 +1,304 @@
+#pragma once
+
+// Sampled guard-page allocations (in the spirit of GWP-ASan). A random fraction of
+// allocations is placed flush against a PROT_NONE page inside a reserved region;
+// freed blocks stay inaccessible until their slot is recycled, oldest first.
+// Touching a guard or freed page faults, and the installed SIGSEGV handler prints
+// a report before handing the fault to the previous handler. Faults outside the
+// guard region go straight to the previous handler, and detection stays on. POSIX only.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "safeptr.hpp"
+
+struct SafeGuardOptions
+{
+    size_t sample_rate = 5000;   // one in sample_rate allocations on average; 1 guards all, 0 none
+    size_t slots = 64;           // guarded blocks kept at once, live or quarantined
+    size_t max_bytes = 65536;    // larger allocations are never sampled
+};
+
+class SampledGuardBackend : public SafeBackend
+{
+private:
+    enum SlotState { kEmpty, kLive, kFreed };
+
+    struct Slot {
+        std::atomic<int> state{kEmpty};
+        std::atomic<uintptr_t> user{0};
+        std::atomic<size_t> bytes{0};
+    };
+
+    SafeGuardOptions options_;
+    SafeBackend* upstream_;
+    size_t page_;
+    size_t slot_bytes_;   // data pages per slot, followed by one guard page
+    char* region_ = nullptr;
+    size_t region_bytes_ = 0;
+    std::vector<Slot> slots_;
+    std::vector<size_t> empty_;
+    std::deque<size_t> quarantine_;  // freed slots, oldest first
+    std::mutex mutex_;
+    std::atomic<size_t> sampled_{0};
+
+    static std::atomic<SampledGuardBackend*>& active() {
+        static std::atomic<SampledGuardBackend*> backend{nullptr};
+        return backend;
+    }
+
+    static struct sigaction& previous_action() {
+        static struct sigaction action;
+        return action;
+    }
+
+    char* slot_begin(size_t idx) const { return region_ + page_ + idx * (slot_bytes_ + page_); }
+    char* slot_end(size_t idx) const { return slot_begin(idx) + slot_bytes_; }
+
+    bool should_sample() {
+        static thread_local size_t countdown = 0;
+        static thread_local uint64_t state = 0;
+        if (options_.sample_rate == 0) {
+            return false;
+        }
+        if (countdown == 0) {
+            if (state == 0) {
+                state = (reinterpret_cast<uintptr_t>(&countdown) ^
+                         static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) | 1;
+            }
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            countdown = options_.sample_rate == 1 ? 1 : 1 + state % (2 * options_.sample_rate);
+        }
+        return --countdown == 0;
+    }
+
+    void* allocate_guarded(size_t bytes, size_t align) {
+        size_t idx;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!empty_.empty()) {
+                idx = empty_.back();
+                empty_.pop_back();
+            } else if (!quarantine_.empty()) {
+                idx = quarantine_.front();
+                quarantine_.pop_front();
+            } else {
+                return nullptr;
+            }
+            slots_[idx].state.store(kEmpty);
+        }
+        uintptr_t user = (reinterpret_cast<uintptr_t>(slot_end(idx)) - bytes) & ~(uintptr_t)(align - 1);
+        char* first_page = reinterpret_cast<char*>(user & ~(uintptr_t)(page_ - 1));
+        if (mprotect(first_page, slot_end(idx) - first_page, PROT_READ | PROT_WRITE) != 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            empty_.push_back(idx);
+            return nullptr;
+        }
+        slots_[idx].user.store(user);
+        slots_[idx].bytes.store(bytes);
+        slots_[idx].state.store(kLive);
+        sampled_.fetch_add(1);
+        return reinterpret_cast<void*>(user);
+    }
+
+    void deallocate_guarded(void* ptr) {
+        size_t idx = nearest_slot(reinterpret_cast<uintptr_t>(ptr));
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slots_[idx].state.load() != kLive || slots_[idx].user.load() != reinterpret_cast<uintptr_t>(ptr)) {
+            report("invalid or double free", reinterpret_cast<uintptr_t>(ptr), idx);
+            abort();
+        }
+        madvise(slot_begin(idx), slot_bytes_, MADV_DONTNEED);
+        mprotect(slot_begin(idx), slot_bytes_, PROT_NONE);
+        slots_[idx].state.store(kFreed);
+        quarantine_.push_back(idx);
+    }
+
+    // Async-signal-safe formatting helpers.
+    static char* put(char* out, const char* text) {
+        while (*text) {
+            *out++ = *text++;
+        }
+        return out;
+    }
+
+    static char* put_number(char* out, uintptr_t value, unsigned base) {
+        char digits[24];
+        size_t n = 0;
+        do {
+            digits[n++] = "0123456789abcdef"[value % base];
+            value /= base;
+        } while (value);
+        if (base == 16) {
+            out = put(out, "0x");
+        }
+        while (n) {
+            *out++ = digits[--n];
+        }
+        return out;
+    }
+
+    // Slot whose block is nearest to addr, which must lie inside the region.
+    size_t nearest_slot(uintptr_t addr) const {
+        uintptr_t base = reinterpret_cast<uintptr_t>(region_) + page_;
+        if (addr < base) {
+            return 0;
+        }
+        size_t idx = (addr - base) / (slot_bytes_ + page_);
+        uintptr_t end = reinterpret_cast<uintptr_t>(slot_end(idx));
+        if (addr >= end && idx + 1 < slots_.size() && slots_[idx + 1].state.load() != kEmpty &&
+            slots_[idx + 1].user.load() - addr < addr - end) {
+            ++idx;
+        }
+        return idx;
+    }
+
+    const char* classify(uintptr_t addr, size_t idx) const {
+        if (slots_[idx].state.load() == kFreed) {
+            return "use after free";
+        }
+        return addr < slots_[idx].user.load() ? "buffer underflow" : "buffer overflow";
+    }
+
+    void report(const char* kind, uintptr_t addr, size_t idx) const {
+        char message[256];
+        char* out = put(message, "SafePointer guard: ");
+        out = put(out, kind);
+        out = put(out, " at ");
+        out = put_number(out, addr, 16);
+        if (slots_[idx].state.load() != kEmpty) {
+            out = put(out, " near a ");
+            out = put_number(out, slots_[idx].bytes.load(), 10);
+            out = put(out, slots_[idx].state.load() == kFreed ? "-byte freed block at " : "-byte block at ");
+            out = put_number(out, slots_[idx].user.load(), 16);
+        }
+        out = put(out, "\n");
+        ssize_t written = write(STDERR_FILENO, message, out - message);
+        (void)written;
+    }
+
+    static void on_fault(int sig, siginfo_t* info, void* context) {
+        SampledGuardBackend* backend = active().load();
+        uintptr_t addr = reinterpret_cast<uintptr_t>(info->si_addr);
+        if (backend && backend->owns(info->si_addr)) {
+            size_t idx = backend->nearest_slot(addr);
+            backend->report(backend->classify(addr, idx), addr, idx);
+            // Returning re-executes the faulting access under the previous disposition.
+            sigaction(sig, &previous_action(), nullptr);
+            return;
+        }
+        // Someone else's fault: chain to the previous handler and stay installed.
+        const struct sigaction& previous = previous_action();
+        if (previous.sa_flags & SA_SIGINFO) {
+            previous.sa_sigaction(sig, info, context);
+        } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(sig);
+        } else {
+            // Default action: let the re-executed access terminate the process.
+            struct sigaction fallback = {};
+            fallback.sa_handler = SIG_DFL;
+            sigaction(sig, &fallback, nullptr);
+        }
+    }
+
+public:
+    explicit SampledGuardBackend(const SafeGuardOptions& options = SafeGuardOptions(), SafeBackend* upstream = nullptr)
+        : options_(options), upstream_(upstream ? upstream : &MallocBackend::instance()),
+          page_(static_cast<size_t>(sysconf(_SC_PAGESIZE))) {
+        if (options_.slots == 0 || options_.max_bytes == 0) {
+            throw std::invalid_argument("Guard slots and size cannot be 0");
+        }
+        slot_bytes_ = (options_.max_bytes + page_ - 1) / page_ * page_;
+        region_bytes_ = page_ + options_.slots * (slot_bytes_ + page_);
+        void* region = mmap(nullptr, region_bytes_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (region == MAP_FAILED) {
+            throw std::runtime_error("Guard region reservation failed");
+        }
+        region_ = static_cast<char*>(region);
+        slots_ = std::vector<Slot>(options_.slots);
+        for (size_t i = options_.slots; i > 0; --i) {
+            empty_.push_back(i - 1);
+        }
+    }
+
+    ~SampledGuardBackend() override {
+        SampledGuardBackend* self = this;
+        if (active().compare_exchange_strong(self, nullptr)) {
+            sigaction(SIGSEGV, &previous_action(), nullptr);
+        }
+        munmap(region_, region_bytes_);
+    }
+
+    SampledGuardBackend(const SampledGuardBackend&) = delete;
+    SampledGuardBackend& operator=(const SampledGuardBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override {
+        if (bytes <= slot_bytes_ && align <= page_ && should_sample()) {
+            if (void* ptr = allocate_guarded(bytes, align)) {
+                return ptr;
+            }
+        }
+        return upstream_->allocate(bytes, align);
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (owns(ptr)) {
+            deallocate_guarded(ptr);
+            return;
+        }
+        upstream_->deallocate(ptr, bytes, align);
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        if (owns(ptr)) {
+            return SafeBackend::reallocate(ptr, old_bytes, new_bytes, align);
+        }
+        return upstream_->reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    bool owns(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        return p >= region_ && p < region_ + region_bytes_;
+    }
+
+    size_t sampled_count() const { return sampled_.load(); }
+
+    // Routes this backend's faults through the reporting SIGSEGV handler.
+    void install_fault_handler() {
+        SampledGuardBackend* expected = nullptr;
+        if (!active().compare_exchange_strong(expected, this)) {
+            throw std::runtime_error("Another guard backend already handles faults");
+        }
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &SampledGuardBackend::on_fault;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &previous_action());
+    }
+
+    // Process-wide mode: a never-destroyed backend wrapping the current default
+    // becomes the default, with the fault handler installed.
+    static SampledGuardBackend& install(const SafeGuardOptions& options = SafeGuardOptions()) {
+        SampledGuardBackend* backend = new SampledGuardBackend(options, &SafeBackend::get_default());
+        backend->install_fault_handler();
+        SafeBackend::set_default(backend);
+        return *backend;
+    }
+};
+
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+
+// 16-bit floating point element types for SafePointer storage: IEEE binary16
+// (half) and bfloat16. Elements convert implicitly to and from float; bulk
+// widening loads and narrowing stores use F16C when the target has it and a
+// bit-exact software path (round to nearest even) otherwise.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__F16C__) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#include "safeptr.hpp"
+
+namespace safeptr_detail {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline float half_bits_to_float(uint16_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    if (exp == 0x1f) {
+        return bits_float(sign | 0x7f800000 | (mant << 13));
+    }
+    if (exp == 0) {
+        float f = static_cast<float>(mant) * bits_float(0x33800000);  // mant * 2^-24
+        return sign ? -f : f;
+    }
+    return bits_float(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+inline uint16_t float_to_half_bits(float f) {
+    uint32_t x = float_bits(f);
+    uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+    if (x > 0x7f800000) {
+        return sign | 0x7e00 | ((x >> 13) & 0x3ff);  // quiet NaN
+    }
+    if (x >= 0x47800000) {
+        return sign | 0x7c00;  // overflow (or infinity)
+    }
+    if (x < 0x38800000) {
+        // Subnormal: adding 0.5f aligns the half subnormal ulp with the float ulp,
+        // so the FPU performs the round-to-nearest-even.
+        return sign | static_cast<uint16_t>(float_bits(bits_float(x) + 0.5f) - 0x3f000000);
+    }
+    uint32_t odd = (x >> 13) & 1;
+    x += 0xc8000fff + odd;  // rebias exponent by -112 and round
+    return sign | static_cast<uint16_t>(x >> 13);
+}
+
+inline float bfloat16_bits_to_float(uint16_t b) {
+    return bits_float(static_cast<uint32_t>(b) << 16);
+}
+
+inline uint16_t float_to_bfloat16_bits(float f) {
+    uint32_t x = float_bits(f);
+    if ((x & 0x7fffffff) > 0x7f800000) {
+        return static_cast<uint16_t>((x >> 16) | 0x40);  // quiet NaN
+    }
+    x += 0x7fff + ((x >> 16) & 1);
+    return static_cast<uint16_t>(x >> 16);
+}
+
+}  // namespace safeptr_detail
+
+struct half
+{
+    uint16_t bits;
+
+    half() = default;
+    half(float value) : bits(safeptr_detail::float_to_half_bits(value)) {}
+    operator float() const { return safeptr_detail::half_bits_to_float(bits); }
+
+    static half from_bits(uint16_t bits) {
+        half h;
+        h.bits = bits;
+        return h;
+    }
+};
+
+struct bfloat16
+{
+    uint16_t bits;
+
+    bfloat16() = default;
+    bfloat16(float value) : bits(safeptr_detail::float_to_bfloat16_bits(value)) {}
+    operator float() const { return safeptr_detail::bfloat16_bits_to_float(bits); }
+
+    static bfloat16 from_bits(uint16_t bits) {
+        bfloat16 b;
+        b.bits = bits;
+        return b;
+    }
+};
+
+namespace safeptr_detail {
+
+template <typename T>
+struct is_half_like : std::integral_constant<bool, std::is_same<T, half>::value || std::is_same<T, bfloat16>::value> {};
+
+inline void widen_n(const half* src, float* dst, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = half_bits_to_float(src[i].bits);
+    }
+}
+
+inline void narrow_n(const float* src, half* dst, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i].bits = float_to_half_bits(src[i]);
+    }
+}
+
+// bfloat16 is the top half of a float, so plain loops vectorise well.
+inline void widen_n(const bfloat16* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = bfloat16_bits_to_float(src[i].bits);
+    }
+}
+
+inline void narrow_n(const float* src, bfloat16* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i].bits = float_to_bfloat16_bits(src[i]);
+    }
+}
+
+// Elements staged through float per chunk when converting to or from 16-bit types.
+constexpr size_t half_chunk = 512;
+
+}  // namespace safeptr_detail
+
+// Conversions involving half/bfloat16 go through float, one stack chunk at a time.
+template <typename From, typename To>
+struct SafeConvert<From, To,
+                   typename std::enable_if<safeptr_detail::is_half_like<From>::value ||
+                                           safeptr_detail::is_half_like<To>::value>::type>
+{
+    static void run(const From* src, To* dst, size_t n, double scale) {
+        if constexpr (std::is_same<From, To>::value) {
+            if (scale == 1.0) {
+                memcpy(dst, src, n * sizeof(From));
+                return;
+            }
+        }
+        if constexpr (safeptr_detail::is_half_like<From>::value && std::is_same<To, float>::value) {
+            if (scale == 1.0) {
+                safeptr_detail::widen_n(src, dst, n);
+                return;
+            }
+        }
+        if constexpr (std::is_same<From, float>::value && safeptr_detail::is_half_like<To>::value) {
+            if (scale == 1.0) {
+                safeptr_detail::narrow_n(src, dst, n);
+                return;
+            }
+        }
+        float buf[safeptr_detail::half_chunk];
+        for (size_t off = 0; off < n; off += safeptr_detail::half_chunk) {
+            size_t m = n - off < safeptr_detail::half_chunk ? n - off : safeptr_detail::half_chunk;
+            if constexpr (safeptr_detail::is_half_like<From>::value) {
+                safeptr_detail::widen_n(src + off, buf, m);
+            } else {
+                SafeConvert<From, float>::run(src + off, buf, m, 1.0);
+            }
+            if (scale != 1.0) {
+                const float s = static_cast<float>(scale);
+                for (size_t i = 0; i < m; ++i) {
+                    buf[i] *= s;
+                }
+            }
+            if constexpr (safeptr_detail::is_half_like<To>::value) {
+                safeptr_detail::narrow_n(buf, dst + off, m);
+            } else {
+                SafeConvert<float, To>::run(buf, dst + off, m, 1.0);
+            }
+        }
+    }
+};
+
+// Bulk widening load of count elements starting at offset.
+template <typename H>
+typename std::enable_if<safeptr_detail::is_half_like<H>::value>::type
+load_widened(const SafePointer<H>& src, size_t offset, float* dst, size_t count) {
+    if (!src.is_allocated() || src.get() == nullptr) {
+        throw std::runtime_error("Cannot load values: memory is not allocated");
+    }
+    if (offset > src.size() || count > src.size() - offset) {
+        throw std::invalid_argument("Source range exceeds buffer size");
+    }
+    safeptr_detail::widen_n(src.get() + offset, dst, count);
+}
+
+// Bulk narrowing store of count floats starting at offset.
+template <typename H>
+typename std::enable_if<safeptr_detail::is_half_like<H>::value>::type
+store_narrowed(SafePointer<H>& dst, size_t offset, const float* src, size_t count) {
+    if (!dst.is_allocated() || dst.get() == nullptr) {
+        throw std::runtime_error("Cannot set values: memory is not allocated");
+    }
+    if (offset > dst.size() || count > dst.size() - offset) {
+        throw std::invalid_argument("Source range exceeds destination space");
+    }
+    safeptr_detail::narrow_n(src, dst.get() + offset, count);
+}
+
+// Sum of all elements, accumulated in float over widened chunks.
+template <typename H>
+typename std::enable_if<safeptr_detail::is_half_like<H>::value, float>::type
+reduce_sum(const SafePointer<H>& sptr) {
+    if (!sptr.is_allocated() || sptr.get() == nullptr) {
+        throw std::runtime_error("Cannot reduce: memory is not allocated");
+    }
+    float buf[safeptr_detail::half_chunk];
+    float acc[8] = {};
+    for (size_t off = 0; off < sptr.size(); off += safeptr_detail::half_chunk) {
+        size_t m = std::min(safeptr_detail::half_chunk, sptr.size() - off);
+        safeptr_detail::widen_n(sptr.get() + off, buf, m);
+        for (size_t i = 0; i < m; ++i) {
+            acc[i % 8] += buf[i];
+        }
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+template <typename H>
+typename std::enable_if<safeptr_detail::is_half_like<H>::value, float>::type
+reduce_dot(const SafePointer<H>& a, const SafePointer<H>& b) {
+    if (!a.is_allocated() || !b.is_allocated() || a.get() == nullptr || b.get() == nullptr) {
+        throw std::runtime_error("Cannot reduce: memory is not allocated");
+    }
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Operands differ in size");
+    }
+    float buf_a[safeptr_detail::half_chunk];
+    float buf_b[safeptr_detail::half_chunk];
+    float acc[8] = {};
+    for (size_t off = 0; off < a.size(); off += safeptr_detail::half_chunk) {
+        size_t m = std::min(safeptr_detail::half_chunk, a.size() - off);
+        safeptr_detail::widen_n(a.get() + off, buf_a, m);
+        safeptr_detail::widen_n(b.get() + off, buf_b, m);
+        for (size_t i = 0; i < m; ++i) {
+            acc[i % 8] += buf_a[i] * buf_b[i];
+        }
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+// Resumable clone/copy/fill/resize. Each step() does at most a byte or time budget
+// of work and returns a progress token, so large operations can be spread over
+// many event-loop iterations. Buffers involved must not be touched between steps.
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "safeptr.hpp"
+
+struct SafeBudget
+{
+    size_t max_bytes = 0;                   // 0: unlimited
+    std::chrono::nanoseconds max_time{0};   // 0: unlimited
+
+    static SafeBudget bytes(size_t n) { return SafeBudget{n, std::chrono::nanoseconds(0)}; }
+    static SafeBudget time(std::chrono::nanoseconds t) { return SafeBudget{0, t}; }
+};
+
+struct SafeProgress
+{
+    size_t done = 0;   // elements processed so far
+    size_t total = 0;
+
+    bool finished() const { return done == total; }
+    double fraction() const { return total ? static_cast<double>(done) / total : 1.0; }
+};
+
+namespace safeptr_detail {
+
+// Slice between clock reads when only a time budget is set.
+constexpr size_t incremental_slice_bytes = 256 * 1024;
+
+template <typename T, typename F>
+void run_budgeted(SafeProgress& progress, const SafeBudget& budget, F process) {
+    if (budget.max_bytes == 0 && budget.max_time.count() == 0) {
+        throw std::invalid_argument("Budget cannot be unlimited");
+    }
+    size_t limit = progress.total - progress.done;
+    if (budget.max_bytes) {
+        limit = std::min(limit, std::max<size_t>(1, budget.max_bytes / sizeof(T)));
+    }
+    size_t slice = std::max<size_t>(1, incremental_slice_bytes / sizeof(T));
+    auto deadline = std::chrono::steady_clock::now() + budget.max_time;
+    size_t end = progress.done + limit;
+    // Always make some progress, even with a budget smaller than one slice.
+    do {
+        size_t hi = std::min(end, progress.done + slice);
+        process(progress.done, hi);
+        progress.done = hi;
+    } while (progress.done < end &&
+             (budget.max_time.count() == 0 || std::chrono::steady_clock::now() < deadline));
+}
+
+}  // namespace safeptr_detail
+
+// Incremental dst.copy(src, size). dst is (re)allocated on construction, keeping its
+// backend; old contents are discarded rather than carried over.
+template <typename T>
+class IncrementalCopy
+{
+private:
+    SafePointer<T>& dst_;
+    const SafePointer<T>& src_;
+    SafeProgress progress_;
+public:
+    IncrementalCopy(SafePointer<T>& dst, const SafePointer<T>& src, size_t size) : dst_(dst), src_(src) {
+        if (!src.is_allocated()) {
+            throw std::runtime_error("Cannot copy from an unallocated SafePointer");
+        }
+        if (size > src.size()) {
+            throw std::invalid_argument("Copy size exceeds source size");
+        }
+        if (&dst == &src) {
+            throw std::invalid_argument("Cannot copy a SafePointer into itself");
+        }
+        dst_.deallocate();
+        dst_.allocate(size);
+        progress_.total = size;
+    }
+
+    SafeProgress step(const SafeBudget& budget) {
+        safeptr_detail::run_budgeted<T>(progress_, budget, [this](size_t lo, size_t hi) {
+            safeptr_detail::copy_elements<T>(src_.get() + lo, src_.get() + hi, dst_.get() + lo);
+        });
+        return progress_;
+    }
+
+    SafeProgress progress() const { return progress_; }
+};
+
+// Incremental clone(); take the result once finished.
+template <typename T>
+class IncrementalClone
+{
+private:
+    const SafePointer<T>& src_;
+    SafePointer<T> out_;
+    SafeProgress progress_;
+public:
+    explicit IncrementalClone(const SafePointer<T>& src) : src_(src) {
+        if (!src.is_allocated()) {
+            throw std::runtime_error("Cannot clone an unallocated SafePointer");
+        }
+        out_.allocate(src.size());
+        progress_.total = src.size();
+    }
+
+    SafeProgress step(const SafeBudget& budget) {
+        safeptr_detail::run_budgeted<T>(progress_, budget, [this](size_t lo, size_t hi) {
+            safeptr_detail::copy_elements<T>(src_.get() + lo, src_.get() + hi, out_.get() + lo);
+        });
+        return progress_;
+    }
+
+    SafeProgress progress() const { return progress_; }
+
+    SafePointer<T> result() {
+        if (!progress_.finished()) {
+            throw std::runtime_error("Clone has not finished");
+        }
+        return std::move(out_);
+    }
+};
+
+template <typename T>
+class IncrementalFill
+{
+private:
+    SafePointer<T>& dst_;
+    T value_;
+    SafeProgress progress_;
+public:
+    IncrementalFill(SafePointer<T>& dst, const T& value) : dst_(dst), value_(value) {
+        if (!dst.is_allocated() || dst.get() == nullptr) {
+            throw std::runtime_error("Cannot fill: memory is not allocated");
+        }
+        progress_.total = dst.size();
+    }
+
+    SafeProgress step(const SafeBudget& budget) {
+        safeptr_detail::run_budgeted<T>(progress_, budget, [this](size_t lo, size_t hi) {
+            std::fill(dst_.get() + lo, dst_.get() + hi, value_);
+        });
+        return progress_;
+    }
+
+    SafeProgress progress() const { return progress_; }
+};
+
+// Incremental resize(): contents are copied into a new buffer step by step and
+// swapped into the target by the step that finishes; until then it is unchanged.
+// The new buffer comes from the target's backend.
+template <typename T>
+class IncrementalResize
+{
+private:
+    SafePointer<T>& target_;
+    SafePointer<T> staging_;
+    SafeProgress progress_;
+public:
+    IncrementalResize(SafePointer<T>& target, size_t size) : target_(target) {
+        if (size == 0) {
+            throw std::invalid_argument("Cannot resize to 0 elements incrementally");
+        }
+        staging_ = SafePointer<T>(size, target.backend());
+        progress_.total = target.is_allocated() ? std::min(size, target.size()) : 0;
+        if (progress_.total == 0) {
+            target_.swap(staging_);
+        }
+    }
+
+    SafeProgress step(const SafeBudget& budget) {
+        if (progress_.finished()) {
+            return progress_;
+        }
+        safeptr_detail::run_budgeted<T>(progress_, budget, [this](size_t lo, size_t hi) {
+            safeptr_detail::copy_elements<T>(target_.get() + lo, target_.get() + hi, staging_.get() + lo);
+        });
+        if (progress_.finished()) {
+            target_.swap(staging_);
+            staging_.deallocate();
+        }
+        return progress_;
+    }
+
+    SafeProgress progress() const { return progress_; }
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+// Layout-change kernels for SafePointer storage viewed as a row-major matrix:
+// cache-oblivious transpose (out-of-place and in-place square), and AoS <-> SoA
+// repacking of homogeneous records, which is the same operation on a
+// records x fields matrix. Recursion halves the longer side until a tile fits in
+// L1; tiles of 4-byte elements are moved with 4x4 SSE register transposes.
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SAFEPTR_LAYOUT_SSE 1
+#endif
+
+#include "safeptr.hpp"
+#include "safeptr_parallel.hpp"
+
+namespace safeptr_detail {
+
+constexpr size_t transpose_tile = 32;  // elements per side at the recursion base
+
+template <typename T>
+void transpose_tile_kernel(const T* src, size_t src_stride, T* dst, size_t dst_stride, size_t rows, size_t cols) {
+    size_t i = 0;
+#if SAFEPTR_LAYOUT_SSE
+    if constexpr (sizeof(T) == 4 && std::is_trivially_copyable<T>::value) {
+        for (; i + 4 <= rows; i += 4) {
+            size_t j = 0;
+            for (; j + 4 <= cols; j += 4) {
+                const float* s = reinterpret_cast<const float*>(src + i * src_stride + j);
+                __m128 r0 = _mm_loadu_ps(s);
+                __m128 r1 = _mm_loadu_ps(s + src_stride);
+                __m128 r2 = _mm_loadu_ps(s + 2 * src_stride);
+                __m128 r3 = _mm_loadu_ps(s + 3 * src_stride);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                float* d = reinterpret_cast<float*>(dst + j * dst_stride + i);
+                _mm_storeu_ps(d, r0);
+                _mm_storeu_ps(d + dst_stride, r1);
+                _mm_storeu_ps(d + 2 * dst_stride, r2);
+                _mm_storeu_ps(d + 3 * dst_stride, r3);
+            }
+            for (; j < cols; ++j) {
+                for (size_t k = i; k < i + 4; ++k) {
+                    dst[j * dst_stride + k] = src[k * src_stride + j];
+                }
+            }
+        }
+    }
+#endif
+    for (; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            dst[j * dst_stride + i] = src[i * src_stride + j];
+        }
+    }
+}
+
+// dst(j, i) = src(i, j) for a rows x cols block.
+template <typename T>
+void transpose_block(const T* src, size_t src_stride, T* dst, size_t dst_stride, size_t rows, size_t cols) {
+    if (rows <= transpose_tile && cols <= transpose_tile) {
+        transpose_tile_kernel(src, src_stride, dst, dst_stride, rows, cols);
+    } else if (rows >= cols) {
+        size_t h = rows / 2 / 4 * 4;  // keep splits on 4x4 kernel boundaries
+        transpose_block(src, src_stride, dst, dst_stride, h, cols);
+        transpose_block(src + h * src_stride, src_stride, dst + h, dst_stride, rows - h, cols);
+    } else {
+        size_t h = cols / 2 / 4 * 4;
+        transpose_block(src, src_stride, dst, dst_stride, rows, h);
+        transpose_block(src + h, src_stride, dst + h * dst_stride, dst_stride, rows, cols - h);
+    }
+}
+
+// Swaps a(i, j) with b(j, i) for a rows x cols block a and cols x rows block b.
+template <typename T>
+void transpose_swap(T* a, T* b, size_t stride, size_t rows, size_t cols) {
+    if (rows <= transpose_tile && cols <= transpose_tile) {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                std::swap(a[i * stride + j], b[j * stride + i]);
+            }
+        }
+    } else if (rows >= cols) {
+        size_t h = rows / 2;
+        transpose_swap(a, b, stride, h, cols);
+        transpose_swap(a + h * stride, b + h, stride, rows - h, cols);
+    } else {
+        size_t h = cols / 2;
+        transpose_swap(a, b, stride, rows, h);
+        transpose_swap(a + h, b + h * stride, stride, rows, cols - h);
+    }
+}
+
+template <typename T>
+void transpose_square(T* a, size_t stride, size_t n) {
+    if (n <= transpose_tile) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                std::swap(a[i * stride + j], a[j * stride + i]);
+            }
+        }
+        return;
+    }
+    size_t h = n / 2;
+    transpose_square(a, stride, h);
+    transpose_square(a + h * stride + h, stride, n - h);
+    transpose_swap(a + h, a + h * stride, stride, h, n - h);
+}
+
+template <typename T>
+void check_matrix(const SafePointer<T>& src, size_t rows, size_t cols) {
+    if (!src.is_allocated() || src.get() == nullptr) {
+        throw std::runtime_error("Cannot transpose: memory is not allocated");
+    }
+    if (rows == 0 || cols == 0 || rows > src.size() / cols) {
+        throw std::invalid_argument("Matrix shape exceeds buffer size");
+    }
+}
+
+}  // namespace safeptr_detail
+
+// dst = transpose of the rows x cols matrix in src; dst is (re)allocated like copy().
+template <typename T>
+void transpose(const SafePointer<T>& src, SafePointer<T>& dst, size_t rows, size_t cols) {
+    safeptr_detail::check_matrix(src, rows, cols);
+    if (&src == &dst) {
+        throw std::invalid_argument("Out-of-place transpose needs distinct buffers");
+    }
+    if (!dst.is_allocated() || dst.size() != rows * cols) {
+        dst.allocate(rows * cols);
+    }
+    safeptr_detail::transpose_block(src.get(), cols, dst.get(), rows, rows, cols);
+}
+
+// Same as transpose(), with bands of rows processed as tasks on the pool.
+template <typename T>
+void parallel_transpose(WorkStealingPool& pool, const SafePointer<T>& src, SafePointer<T>& dst,
+                        size_t rows, size_t cols) {
+    safeptr_detail::check_matrix(src, rows, cols);
+    if (&src == &dst) {
+        throw std::invalid_argument("Out-of-place transpose needs distinct buffers");
+    }
+    if (!dst.is_allocated() || dst.size() != rows * cols) {
+        dst.allocate(rows * cols);
+    }
+    const T* in = src.get();
+    T* out = dst.get();
+    size_t band = std::max<size_t>(safeptr_detail::transpose_tile,
+                                   safeptr_detail::default_grain<T>() / cols / 4 * 4);
+    pool.parallel_for(0, rows, band, [in, out, rows, cols](size_t lo, size_t hi) {
+        safeptr_detail::transpose_block(in + lo * cols, cols, out + lo, rows, hi - lo, cols);
+    });
+}
+
+template <typename T>
+void parallel_transpose(const SafePointer<T>& src, SafePointer<T>& dst, size_t rows, size_t cols) {
+    parallel_transpose(WorkStealingPool::instance(), src, dst, rows, cols);
+}
+
+// In-place transpose of the n x n matrix at the start of sptr.
+template <typename T>
+void transpose_in_place(SafePointer<T>& sptr, size_t n) {
+    safeptr_detail::check_matrix(sptr, n, n);
+    safeptr_detail::transpose_square(sptr.get(), n, n);
+}
+
+// Records of `fields` elements each, stored one after another (AoS), become one
+// contiguous run per field (SoA), and back.
+template <typename T>
+void aos_to_soa(const SafePointer<T>& src, SafePointer<T>& dst, size_t fields) {
+    if (fields == 0 || src.size() % fields != 0) {
+        throw std::invalid_argument("Buffer size is not a whole number of records");
+    }
+    transpose(src, dst, src.size() / fields, fields);
+}
+
+template <typename T>
+void soa_to_aos(const SafePointer<T>& src, SafePointer<T>& dst, size_t fields) {
+    if (fields == 0 || src.size() % fields != 0) {
+        throw std::invalid_argument("Buffer size is not a whole number of records");
+    }
+    transpose(src, dst, fields, src.size() / fields);
+}
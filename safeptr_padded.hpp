@@ -0,0 +1,99 @@
+#pragma once
+
+// SafePointer variant that gives every element its own cache line, for per-thread
+// slots (counters, state) that would otherwise false-share with their neighbours.
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+#include "safeptr.hpp"
+
+// Destructive interference size. 64 bytes fits x86 and most ARM cores; builds for
+// parts with 128-byte lines (or adjacent-line prefetch) can raise it.
+#ifndef SAFEPTR_CACHE_LINE
+#define SAFEPTR_CACHE_LINE 64
+#endif
+
+template <typename T, size_t Align = SAFEPTR_CACHE_LINE>
+struct alignas(Align) CachePadded
+{
+    T value;
+};
+
+template <typename T, size_t Align = SAFEPTR_CACHE_LINE>
+class PaddedSafePointer
+{
+private:
+    using Slot = CachePadded<T, Align>;
+    SafePointer<Slot> slots_;  // over-aligned, so the backend returns Align-aligned storage
+
+public:
+    class iterator
+    {
+    private:
+        Slot* slot_;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        explicit iterator(Slot* slot) : slot_(slot) {}
+        T& operator*() const { return slot_->value; }
+        T* operator->() const { return &slot_->value; }
+        T& operator[](difference_type n) const { return slot_[n].value; }
+        iterator& operator++() { ++slot_; return *this; }
+        iterator operator++(int) { iterator old = *this; ++slot_; return old; }
+        iterator& operator--() { --slot_; return *this; }
+        iterator operator--(int) { iterator old = *this; --slot_; return old; }
+        iterator& operator+=(difference_type n) { slot_ += n; return *this; }
+        iterator& operator-=(difference_type n) { slot_ -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(slot_ + n); }
+        iterator operator-(difference_type n) const { return iterator(slot_ - n); }
+        difference_type operator-(const iterator& other) const { return slot_ - other.slot_; }
+        bool operator==(const iterator& other) const { return slot_ == other.slot_; }
+        bool operator!=(const iterator& other) const { return slot_ != other.slot_; }
+        bool operator<(const iterator& other) const { return slot_ < other.slot_; }
+        bool operator>(const iterator& other) const { return slot_ > other.slot_; }
+        bool operator<=(const iterator& other) const { return slot_ <= other.slot_; }
+        bool operator>=(const iterator& other) const { return slot_ >= other.slot_; }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+    };
+
+    PaddedSafePointer() = default;
+    explicit PaddedSafePointer(size_t size) { allocate(size); }
+
+    static constexpr size_t slot_size() { return sizeof(Slot); }
+
+    void allocate(size_t size) { slots_.allocate(size); }
+    void deallocate() { slots_.deallocate(); }
+    void resize(size_t size) { slots_.resize(size); }
+
+    bool is_allocated() const { return slots_.is_allocated(); }
+    size_t size() const { return slots_.size(); }
+
+    T& operator[](size_t idx) const { return slots_.get()[idx].value; }
+
+    void set_value(const T& value, size_t idx = 0) {
+        if (!slots_.is_allocated() || slots_.get() == nullptr) {
+            throw std::runtime_error("Cannot set value: memory is not allocated");
+        }
+        slots_.get()[idx].value = value;
+    }
+
+    void fill(const T& value) {
+        if (!slots_.is_allocated() || slots_.get() == nullptr) {
+            throw std::runtime_error("Cannot fill: memory is not allocated");
+        }
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            slots_.get()[i].value = value;
+        }
+    }
+
+    iterator begin() const { return iterator(slots_.begin()); }
+    iterator end() const { return iterator(slots_.end()); }
+
+    void swap(PaddedSafePointer& other) { slots_.swap(other.slots_); }
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "safeptr.hpp"
+#include "safeptr_workers.hpp"
+
+namespace safeptr_detail {
+
+// Elements per chunk so that one chunk of source plus destination stays in L1.
+template <typename T>
+size_t default_grain() {
+    return std::max<size_t>(1, 16384 / sizeof(T));
+}
+
+}  // namespace safeptr_detail
+
+template <typename T, typename F>
+void parallel_for_each(WorkStealingPool& pool, SafePointer<T>& sptr, F f, size_t grain = 0) {
+    if (!sptr.is_allocated() || sptr.get() == nullptr) {
+        throw std::runtime_error("Cannot iterate: memory is not allocated");
+    }
+    T* data = sptr.get();
+    pool.parallel_for(0, sptr.size(), grain ? grain : safeptr_detail::default_grain<T>(),
+                      [data, &f](size_t lo, size_t hi) {
+                          for (size_t i = lo; i < hi; ++i) {
+                              f(data[i]);
+                          }
+                      });
+}
+
+template <typename T, typename F>
+void parallel_for_each(SafePointer<T>& sptr, F f, size_t grain = 0) {
+    parallel_for_each(WorkStealingPool::instance(), sptr, f, grain);
+}
+
+// Writes f(src[i]) to dst[i]; dst is (re)allocated to src.size() elements like copy().
+template <typename T, typename U, typename F>
+void parallel_transform(WorkStealingPool& pool, const SafePointer<T>& src, SafePointer<U>& dst, F f, size_t grain = 0) {
+    if (!src.is_allocated() || src.get() == nullptr) {
+        throw std::runtime_error("Cannot transform from an unallocated SafePointer");
+    }
+    if (!dst.is_allocated() || dst.size() != src.size()) {
+        dst.allocate(src.size());
+    }
+    const T* in = src.get();
+    U* out = dst.get();
+    pool.parallel_for(0, src.size(), grain ? grain : safeptr_detail::default_grain<T>(),
+                      [in, out, &f](size_t lo, size_t hi) {
+                          for (size_t i = lo; i < hi; ++i) {
+                              out[i] = f(in[i]);
+                          }
+                      });
+}
+
+template <typename T, typename U, typename F>
+void parallel_transform(const SafePointer<T>& src, SafePointer<U>& dst, F f, size_t grain = 0) {
+    parallel_transform(WorkStealingPool::instance(), src, dst, f, grain);
+}
+
+// Fills dst with g(i), or g() when the generator takes no index. g is called concurrently.
+template <typename T, typename G>
+void parallel_generate(WorkStealingPool& pool, SafePointer<T>& dst, G g, size_t grain = 0) {
+    if (!dst.is_allocated() || dst.get() == nullptr) {
+        throw std::runtime_error("Cannot generate: memory is not allocated");
+    }
+    T* out = dst.get();
+    pool.parallel_for(0, dst.size(), grain ? grain : safeptr_detail::default_grain<T>(),
+                      [out, &g](size_t lo, size_t hi) {
+                          for (size_t i = lo; i < hi; ++i) {
+                              if constexpr (std::is_invocable<G&, size_t>::value) {
+                                  out[i] = g(i);
+                              } else {
+                                  out[i] = g();
+                              }
+                          }
+                      });
+}
+
+template <typename T, typename G>
+void parallel_generate(SafePointer<T>& dst, G g, size_t grain = 0) {
+    parallel_generate(WorkStealingPool::instance(), dst, g, grain);
+}
+
+// convert_into() split over the pool.
+template <typename T, typename U>
+void parallel_convert_into(WorkStealingPool& pool, const SafePointer<T>& src, SafePointer<U>& dst,
+                           double scale = 1.0, size_t grain = 0) {
+    if (!src.is_allocated() || src.get() == nullptr) {
+        throw std::runtime_error("Cannot convert from an unallocated SafePointer");
+    }
+    if (!dst.is_allocated() || dst.size() != src.size()) {
+        dst.allocate(src.size());
+    }
+    const T* in = src.get();
+    U* out = dst.get();
+    pool.parallel_for(0, src.size(), grain ? grain : safeptr_detail::default_grain<T>(),
+                      [in, out, scale](size_t lo, size_t hi) {
+                          SafeConvert<T, U>::run(in + lo, out + lo, hi - lo, scale);
+                      });
+}
+
+template <typename T, typename U>
+void parallel_convert_into(const SafePointer<T>& src, SafePointer<U>& dst, double scale = 1.0, size_t grain = 0) {
+    parallel_convert_into(WorkStealingPool::instance(), src, dst, scale, grain);
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+// Per-CPU pool backend. Same size classes and block headers as PoolBackend
+// (safeptr_detail::PoolLayout), but the caches belong to CPUs rather than threads,
+// so thousands of mostly idle threads retain at most one cache per core
+// (kCacheBytes per size class).
+//
+// The running CPU comes from safeptr_detail::current_cpu_id() (the rseq area, else
+// sched_getcpu()). A thread can be migrated between reading its CPU and touching
+// that cache, so each cache is guarded by a spinlock that is uncontended except
+// right after a migration or preemption; true rseq critical sections would need
+// per-architecture assembly. Where no CPU number is available, threads are spread
+// round-robin over the same per-core caches rather than given thread-local caches:
+// per-thread caches would bring back the retention this backend exists to bound,
+// and the spinlocks already make sharing a cache safe.
+// Caches exchange half their contents with a central free list when they run
+// empty or full.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "safeptr.hpp"
+#include "safeptr_cpu.hpp"
+#include "safeptr_padded.hpp"
+#include "safeptr_pool.hpp"
+
+namespace safeptr_detail {
+
+inline void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+}  // namespace safeptr_detail
+
+class PerCpuPoolBackend : public SafeBackend
+{
+private:
+    using Layout = safeptr_detail::PoolLayout;
+
+public:
+    static constexpr size_t kHeader = Layout::kHeader;
+    static constexpr size_t kClasses = Layout::kClasses;
+    static constexpr size_t kMaxPooled = Layout::kMaxPooled;
+    static constexpr size_t kChunkBytes = Layout::kChunkBytes;
+    static constexpr size_t kCacheBytes = 64 * 1024;  // per CPU and size class
+    static constexpr size_t kMaxSlots = 64;
+
+private:
+
+    struct alignas(SAFEPTR_CACHE_LINE) CpuCache {
+        std::atomic<bool> locked{false};
+        uint32_t count[kClasses] = {};
+        void* slots[kClasses][kMaxSlots];
+    };
+
+    SafeBackend* upstream_;
+    std::unique_ptr<CpuCache[]> caches_;
+    size_t ncaches_;
+    std::mutex central_mutex_;  // guards everything below
+    void* central_[kClasses] = {};
+    char* chunk_cur_ = nullptr;
+    char* chunk_end_ = nullptr;
+    std::vector<char*> chunks_;
+    std::atomic<size_t> reserved_{0};
+
+    static uint32_t capacity(size_t c) {
+        return static_cast<uint32_t>(std::min(kMaxSlots, std::max<size_t>(2, kCacheBytes / Layout::class_bytes(c))));
+    }
+
+    CpuCache& local_cache() {
+        int cpu = safeptr_detail::current_cpu_id();
+        if (cpu < 0) {
+            static std::atomic<size_t> next{0};
+            static thread_local size_t index = next.fetch_add(1);
+            return caches_[index % ncaches_];
+        }
+        return caches_[static_cast<size_t>(cpu) % ncaches_];
+    }
+
+    static void lock(CpuCache& cache) {
+        for (int spins = 0; cache.locked.exchange(true, std::memory_order_acquire);) {
+            while (cache.locked.load(std::memory_order_relaxed)) {
+                // The holder was most likely preempted on this CPU; let it run.
+                if (++spins < 64) {
+                    safeptr_detail::spin_pause();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    static void unlock(CpuCache& cache) { cache.locked.store(false, std::memory_order_release); }
+
+    // Caller holds the cache lock. Moves up to half the capacity from the central
+    // list into the cache, carving fresh blocks when the central list runs out.
+    bool refill(CpuCache& cache, size_t c) {
+        uint32_t want = std::max<uint32_t>(1, capacity(c) / 2);
+        std::lock_guard<std::mutex> lock(central_mutex_);
+        while (cache.count[c] < want) {
+            void* payload = central_[c];
+            if (payload) {
+                central_[c] = *static_cast<void**>(payload);
+            } else {
+                if (static_cast<size_t>(chunk_end_ - chunk_cur_) < Layout::block_bytes(c)) {
+                    char* chunk = static_cast<char*>(upstream_->allocate(kChunkBytes, kHeader));
+                    if (!chunk) {
+                        break;
+                    }
+                    chunks_.push_back(chunk);
+                    reserved_.fetch_add(kChunkBytes, std::memory_order_relaxed);
+                    chunk_cur_ = chunk;
+                    chunk_end_ = chunk + kChunkBytes;
+                }
+                payload = Layout::carve(chunk_cur_, c, nullptr);
+            }
+            cache.slots[c][cache.count[c]++] = payload;
+        }
+        return cache.count[c] > 0;
+    }
+
+    // Caller holds the cache lock. Returns the older half of a full cache.
+    void flush(CpuCache& cache, size_t c) {
+        uint32_t keep = capacity(c) / 2;
+        std::lock_guard<std::mutex> lock(central_mutex_);
+        for (uint32_t i = 0; i < cache.count[c] - keep; ++i) {
+            void* payload = cache.slots[c][i];
+            *static_cast<void**>(payload) = central_[c];
+            central_[c] = payload;
+        }
+        std::copy(cache.slots[c] + cache.count[c] - keep, cache.slots[c] + cache.count[c], cache.slots[c]);
+        cache.count[c] = keep;
+    }
+
+public:
+    explicit PerCpuPoolBackend(SafeBackend* upstream = nullptr)
+        : upstream_(upstream ? upstream : &MallocBackend::instance()),
+          ncaches_(std::max(1u, std::thread::hardware_concurrency())) {
+        caches_.reset(new CpuCache[ncaches_]);
+    }
+
+    ~PerCpuPoolBackend() override {
+        for (char* chunk : chunks_) {
+            upstream_->deallocate(chunk, kChunkBytes, kHeader);
+        }
+    }
+
+    PerCpuPoolBackend(const PerCpuPoolBackend&) = delete;
+    PerCpuPoolBackend& operator=(const PerCpuPoolBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override {
+        if (!Layout::pooled(bytes, align)) {
+            return Layout::allocate_upstream(*upstream_, bytes, align);
+        }
+        size_t c = Layout::class_of(bytes);
+        CpuCache& cache = local_cache();
+        lock(cache);
+        void* payload = nullptr;
+        if (cache.count[c] > 0 || refill(cache, c)) {
+            payload = cache.slots[c][--cache.count[c]];
+        }
+        unlock(cache);
+        return payload;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (Layout::deallocate_upstream(*upstream_, ptr, bytes, align)) {
+            return;
+        }
+        size_t c = Layout::header_of(ptr)->size_class;
+        CpuCache& cache = local_cache();
+        lock(cache);
+        if (cache.count[c] == capacity(c)) {
+            flush(cache, c);
+        }
+        cache.slots[c][cache.count[c]++] = ptr;
+        unlock(cache);
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        if (Layout::fits_in_place(ptr, new_bytes, align)) {
+            return ptr;
+        }
+        return SafeBackend::reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    size_t caches() const { return ncaches_; }
+
+    // Bytes of chunk memory obtained from upstream (not counting direct upstream blocks).
+    size_t reserved() const { return reserved_.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+// Size-class pool backend. Requests up to kMaxPooled bytes are rounded up to a
+// power of two and served from per-thread free lists, refilled by carving chunks
+// obtained from the upstream backend; larger or over-aligned requests go upstream
+// directly. Every block carries a 16-byte header in front of the payload that
+// records its size class and the cache it was carved from. A block freed by another
+// thread goes back to that owning cache through a lock-free remote-free list, which
+// the owner drains in one batch when a local list runs dry, so memory does not
+// drift from allocating to freeing threads. A thread's cache outlives the thread:
+// it is handed to the next thread that touches the pool. Chunks return upstream
+// only when the pool is destroyed.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "safeptr.hpp"
+
+namespace safeptr_detail {
+
+// Size classes and block layout shared by PoolBackend and PerCpuPoolBackend. Every
+// block starts with a 16-byte Header in front of the payload; blocks too large or
+// too aligned for a class are served upstream with the same header, marked kUpstream.
+struct PoolLayout
+{
+    static constexpr size_t kHeader = 16;
+    static constexpr size_t kMinClassShift = 4;   // 16-byte payloads
+    static constexpr size_t kClasses = 13;        // up to 64 KiB
+    static constexpr size_t kMaxPooled = size_t(1) << (kMinClassShift + kClasses - 1);
+    static constexpr size_t kChunkBytes = 256 * 1024;
+    static constexpr uint32_t kUpstream = UINT32_MAX;  // header class of blocks served upstream
+
+    struct Header {
+        uint32_t size_class;
+        uint32_t offset;  // payload minus block start, for upstream blocks
+        void* owner;      // backend-specific, e.g. the cache a block was carved from
+    };
+    static_assert(sizeof(Header) == kHeader, "block header must keep 16-byte payload alignment");
+
+    static bool pooled(size_t bytes, size_t align) { return bytes <= kMaxPooled && align <= kHeader; }
+
+    static size_t class_of(size_t bytes) {
+        size_t c = 0;
+        while ((size_t(1) << (kMinClassShift + c)) < bytes) {
+            ++c;
+        }
+        return c;
+    }
+
+    static size_t class_bytes(size_t c) { return size_t(1) << (kMinClassShift + c); }
+
+    static size_t block_bytes(size_t c) { return kHeader + class_bytes(c); }
+
+    static Header* header_of(void* ptr) { return reinterpret_cast<Header*>(static_cast<char*>(ptr) - kHeader); }
+
+    // Writes a class-c header at cur, which must have block_bytes(c) left, advances
+    // cur past the block and returns its payload.
+    static void* carve(char*& cur, size_t c, void* owner) {
+        Header* header = reinterpret_cast<Header*>(cur);
+        header->size_class = static_cast<uint32_t>(c);
+        header->offset = kHeader;
+        header->owner = owner;
+        cur += block_bytes(c);
+        return header + 1;
+    }
+
+    static void* allocate_upstream(SafeBackend& upstream, size_t bytes, size_t align) {
+        size_t offset = std::max(kHeader, align);
+        char* block = static_cast<char*>(upstream.allocate(bytes + offset, offset));
+        if (!block) {
+            return nullptr;
+        }
+        Header* header = reinterpret_cast<Header*>(block + offset) - 1;
+        header->size_class = kUpstream;
+        header->offset = static_cast<uint32_t>(offset);
+        header->owner = nullptr;
+        return block + offset;
+    }
+
+    // Returns an upstream block to upstream; false for pooled blocks, left to the caller.
+    static bool deallocate_upstream(SafeBackend& upstream, void* ptr, size_t bytes, size_t align) {
+        Header* header = header_of(ptr);
+        if (header->size_class != kUpstream) {
+            return false;
+        }
+        size_t offset = header->offset;
+        upstream.deallocate(static_cast<char*>(ptr) - offset, bytes + offset, std::max(kHeader, align));
+        return true;
+    }
+
+    // True when a pooled block already has room for new_bytes, so reallocation is a no-op.
+    static bool fits_in_place(void* ptr, size_t new_bytes, size_t align) {
+        if (!ptr || !pooled(new_bytes, align)) {
+            return false;
+        }
+        uint32_t c = header_of(ptr)->size_class;
+        return c != kUpstream && class_of(new_bytes) == c;
+    }
+};
+
+}  // namespace safeptr_detail
+
+class PoolBackend : public SafeBackend
+{
+private:
+    using Layout = safeptr_detail::PoolLayout;
+    using Header = Layout::Header;
+
+public:
+    static constexpr size_t kHeader = Layout::kHeader;
+    static constexpr size_t kClasses = Layout::kClasses;
+    static constexpr size_t kMaxPooled = Layout::kMaxPooled;
+    static constexpr size_t kChunkBytes = Layout::kChunkBytes;
+
+private:
+    struct Cache {
+        void* free[kClasses] = {};  // intrusive lists linked through the payload
+        std::atomic<void*> remote{nullptr};  // blocks freed by other threads, any class
+        char* chunk_cur = nullptr;
+        char* chunk_end = nullptr;
+        std::atomic<bool> orphaned{false};
+    };
+
+    struct LocalEntry {
+        uint64_t pool_id;
+        std::weak_ptr<void> pool_alive;  // expires when the pool is destroyed
+        std::shared_ptr<Cache> cache;
+    };
+
+    struct LocalCaches {
+        std::vector<LocalEntry> entries;
+
+        ~LocalCaches() {
+            for (LocalEntry& entry : entries) {
+                entry.cache->orphaned.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    SafeBackend* upstream_;
+    uint64_t id_;
+    std::shared_ptr<void> alive_ = std::make_shared<char>();
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Cache>> caches_;
+    std::vector<char*> chunks_;
+    std::atomic<size_t> reserved_{0};
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{1};
+        return id.fetch_add(1);
+    }
+
+    static LocalCaches& local_caches() {
+        static thread_local LocalCaches caches;
+        return caches;
+    }
+
+    friend struct PoolBackendProbe;  // test hook: inspects local_caches()
+
+    Cache& local_cache() {
+        // Entries of destroyed pools are dropped on the way, so threads that outlive
+        // many short-lived pools keep neither their caches nor a long scan.
+        std::vector<LocalEntry>& entries = local_caches().entries;
+        for (size_t i = 0; i < entries.size();) {
+            if (entries[i].pool_id == id_) {
+                return *entries[i].cache;
+            }
+            if (entries[i].pool_alive.expired()) {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        std::shared_ptr<Cache> cache;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& candidate : caches_) {
+                bool orphaned = true;
+                if (candidate->orphaned.compare_exchange_strong(orphaned, false, std::memory_order_acquire)) {
+                    cache = candidate;
+                    break;
+                }
+            }
+            if (!cache) {
+                cache = std::make_shared<Cache>();
+                caches_.push_back(cache);
+            }
+        }
+        entries.push_back(LocalEntry{id_, alive_, cache});
+        return *cache;
+    }
+
+    bool refill(Cache& cache, size_t c) {
+        if (static_cast<size_t>(cache.chunk_end - cache.chunk_cur) < Layout::block_bytes(c)) {
+            char* chunk = static_cast<char*>(upstream_->allocate(kChunkBytes, kHeader));
+            if (!chunk) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                chunks_.push_back(chunk);
+            }
+            reserved_.fetch_add(kChunkBytes, std::memory_order_relaxed);
+            cache.chunk_cur = chunk;
+            cache.chunk_end = chunk + kChunkBytes;
+        }
+        void* payload = Layout::carve(cache.chunk_cur, c, &cache);
+        *static_cast<void**>(payload) = cache.free[c];
+        cache.free[c] = payload;
+        return true;
+    }
+
+    // Moves every remotely freed block onto the owner's local lists.
+    static void drain_remote(Cache& cache) {
+        if (!cache.remote.load(std::memory_order_relaxed)) {
+            return;
+        }
+        void* node = cache.remote.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            void* next = *static_cast<void**>(node);
+            uint32_t c = Layout::header_of(node)->size_class;
+            *static_cast<void**>(node) = cache.free[c];
+            cache.free[c] = node;
+            node = next;
+        }
+    }
+
+    static void push_remote(Cache& owner, void* ptr) {
+        void* head = owner.remote.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void**>(ptr) = head;
+        } while (!owner.remote.compare_exchange_weak(head, ptr, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+public:
+    explicit PoolBackend(SafeBackend* upstream = nullptr)
+        : upstream_(upstream ? upstream : &MallocBackend::instance()), id_(next_id()) {}
+
+    ~PoolBackend() override {
+        for (char* chunk : chunks_) {
+            upstream_->deallocate(chunk, kChunkBytes, kHeader);
+        }
+    }
+
+    PoolBackend(const PoolBackend&) = delete;
+    PoolBackend& operator=(const PoolBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override {
+        if (!Layout::pooled(bytes, align)) {
+            return Layout::allocate_upstream(*upstream_, bytes, align);
+        }
+        size_t c = Layout::class_of(bytes);
+        Cache& cache = local_cache();
+        if (!cache.free[c]) {
+            drain_remote(cache);
+            if (!cache.free[c] && !refill(cache, c)) {
+                return nullptr;
+            }
+        }
+        void* payload = cache.free[c];
+        cache.free[c] = *static_cast<void**>(payload);
+        return payload;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (Layout::deallocate_upstream(*upstream_, ptr, bytes, align)) {
+            return;
+        }
+        Header* header = Layout::header_of(ptr);
+        Cache& cache = local_cache();
+        if (header->owner != &cache) {
+            push_remote(*static_cast<Cache*>(header->owner), ptr);
+            return;
+        }
+        *static_cast<void**>(ptr) = cache.free[header->size_class];
+        cache.free[header->size_class] = ptr;
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        if (Layout::fits_in_place(ptr, new_bytes, align)) {
+            return ptr;  // same size class: nothing to move
+        }
+        return SafeBackend::reallocate(ptr, old_bytes, new_bytes, align);
+    }
+
+    // Bytes of chunk memory obtained from upstream (not counting direct upstream blocks).
+    size_t reserved() const { return reserved_.load(std::memory_order_relaxed); }
+
+};
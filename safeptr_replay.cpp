@@ -0,0 +1,145 @@
+// Replays a SafePointer allocation trace (see safeptr_trace.hpp) against each
+// backend and reports replay time, peak RSS and fragmentation. Every backend runs
+// in a forked child so peak RSS is measured from a clean process. POSIX only.
+//
+//     g++ -std=c++17 -O2 -pthread safeptr_replay.cpp -o safeptr_replay
+//     ./safeptr_replay trace.bin [malloc] [pool] [arena]
+//
+// Fragmentation is the share of the replay's RSS growth not explained by the
+// peak of live requested bytes: 1 - peak_live / (peak_rss - baseline_rss).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "safeptr_arena.hpp"
+#include "safeptr_pool.hpp"
+#include "safeptr_trace.hpp"
+
+namespace {
+
+struct ChildReport {
+    SafeReplayStats stats;
+    size_t baseline_rss;
+    size_t peak_rss;
+};
+
+std::unique_ptr<SafeBackend> make_backend(const std::string& name) {
+    if (name == "pool") {
+        return std::unique_ptr<SafeBackend>(new PoolBackend());
+    }
+    if (name == "arena") {
+        return std::unique_ptr<SafeBackend>(new ArenaBackend());
+    }
+    return nullptr;  // malloc: the shared MallocBackend instance
+}
+
+size_t current_rss() {
+    size_t rss = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        unsigned long pages_total, pages_resident;
+        if (fscanf(statm, "%lu %lu", &pages_total, &pages_resident) == 2) {
+            rss = pages_resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+        fclose(statm);
+    }
+    return rss;
+}
+
+size_t peak_rss() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+bool run_child(const std::string& name, const std::vector<SafeTraceEvent>& events, ChildReport& report) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        ChildReport child;
+        child.baseline_rss = current_rss();
+        {
+            std::unique_ptr<SafeBackend> backend = make_backend(name);
+            child.stats = replay_trace(events, backend ? *backend : MallocBackend::instance());
+            child.peak_rss = peak_rss();
+        }
+        bool sent = write(fds[1], &child, sizeof(child)) == static_cast<ssize_t>(sizeof(child));
+        _exit(sent ? 0 : 1);
+    }
+    close(fds[1]);
+    bool received = read(fds[0], &report, sizeof(report)) == static_cast<ssize_t>(sizeof(report));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.bin [malloc] [pool] [arena]\n", argv[0]);
+        return 2;
+    }
+    std::vector<std::string> names;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "malloc") != 0 && strcmp(argv[i], "pool") != 0 && strcmp(argv[i], "arena") != 0) {
+            fprintf(stderr, "unknown backend: %s\n", argv[i]);
+            return 2;
+        }
+        names.push_back(argv[i]);
+    }
+    if (names.empty()) {
+        names = {"malloc", "pool", "arena"};
+    }
+
+    std::vector<SafeTraceEvent> events;
+    try {
+        events = read_trace(argv[1]);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    printf("%zu events\n", events.size());
+    printf("%-8s %12s %14s %14s %14s %8s\n", "backend", "time (ms)", "peak live KiB", "peak RSS KiB", "RSS growth KiB",
+           "frag %");
+    for (const std::string& name : names) {
+        ChildReport report;
+        if (!run_child(name, events, report)) {
+            printf("%-8s failed\n", name.c_str());
+            continue;
+        }
+        size_t growth = report.peak_rss > report.baseline_rss ? report.peak_rss - report.baseline_rss : 0;
+        double frag = growth > report.stats.peak_live_bytes
+                          ? 100.0 * (1.0 - static_cast<double>(report.stats.peak_live_bytes) / growth)
+                          : 0.0;
+        printf("%-8s %12.3f %14zu %14zu %14zu %8.1f", name.c_str(), report.stats.seconds * 1e3,
+               report.stats.peak_live_bytes / 1024, report.peak_rss / 1024, growth / 1024, frag);
+        if (report.stats.failures) {
+            printf("  (%zu failed allocations)", report.stats.failures);
+        }
+        printf("\n");
+    }
+    return 0;
+}
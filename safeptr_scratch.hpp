@@ -0,0 +1,152 @@
+#pragma once
+
+// Per-thread scratch memory. thread_scratch<T>(n) hands out uninitialised storage
+// (like SafePointer::allocate) from a thread-local stack of SafePointer blocks.
+// Buffers are released when they go out of scope, on the same thread; the blocks are
+// kept and reused, growing geometrically until one block covers the peak depth.
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "safeptr.hpp"
+
+class ScratchArena
+{
+private:
+    struct Frame {
+        size_t block;
+        size_t offset;
+        bool released;
+    };
+
+    static constexpr size_t kMinBlockBytes = 64 * 1024;
+
+    std::vector<SafePointer<unsigned char>> blocks_;
+    size_t block_ = 0;   // block currently being carved
+    size_t offset_ = 0;  // bytes used in it
+    std::vector<Frame> frames_;
+
+    static size_t align_offset(const unsigned char* base, size_t offset, size_t align) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(base) + offset;
+        return offset + ((align - addr % align) % align);
+    }
+
+    bool fits(size_t block, size_t offset, size_t bytes, size_t align) const {
+        const SafePointer<unsigned char>& b = blocks_[block];
+        size_t start = align_offset(b.get(), offset, align);
+        return start <= b.size() && bytes <= b.size() - start;
+    }
+
+    // Once the stack is empty, replace a chain of blocks by one block of their total size.
+    void consolidate() {
+        size_t total = 0;
+        for (const SafePointer<unsigned char>& b : blocks_) {
+            total += b.size();
+        }
+        blocks_.clear();
+        blocks_.emplace_back(total);
+        block_ = 0;
+        offset_ = 0;
+    }
+
+public:
+    static ScratchArena& local() {
+        static thread_local ScratchArena arena;
+        return arena;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const SafePointer<unsigned char>& b : blocks_) {
+            total += b.size();
+        }
+        return total;
+    }
+
+    size_t depth() const { return frames_.size(); }
+
+    // The frame is recorded only once the storage is in place, so a failed
+    // allocation leaves the stack as it was.
+    void* push(size_t bytes, size_t align, size_t& frame) {
+        Frame saved{block_, offset_, false};
+        frames_.reserve(frames_.size() + 1);
+        if (blocks_.empty() || !fits(block_, offset_, bytes, align)) {
+            if (!blocks_.empty() && block_ + 1 < blocks_.size() && fits(block_ + 1, 0, bytes, align)) {
+                ++block_;
+            } else {
+                // Blocks past the current one are free but too small: drop them for a bigger one.
+                if (!blocks_.empty()) {
+                    blocks_.resize(block_ + 1);
+                }
+                size_t grow = std::max(kMinBlockBytes, std::max(2 * capacity(), bytes + align));
+                blocks_.emplace_back(grow);
+                block_ = blocks_.size() - 1;
+            }
+            offset_ = 0;
+        }
+        size_t start = align_offset(blocks_[block_].get(), offset_, align);
+        offset_ = start + bytes;
+        frames_.push_back(saved);
+        frame = frames_.size() - 1;
+        return blocks_[block_].get() + start;
+    }
+
+    void pop(size_t frame) {
+        frames_[frame].released = true;
+        while (!frames_.empty() && frames_.back().released) {
+            block_ = frames_.back().block;
+            offset_ = frames_.back().offset;
+            frames_.pop_back();
+        }
+        if (frames_.empty() && blocks_.size() > 1) {
+            consolidate();
+        }
+    }
+};
+
+// Scoped view of scratch storage; move-only, released on destruction. Arenas are
+// not synchronised: a buffer must be destroyed on the thread that created it.
+template <typename T>
+class ScratchBuffer
+{
+private:
+    T* ptr_ = nullptr;
+    size_t size_ = 0;
+    size_t frame_ = 0;
+    ScratchArena* arena_ = nullptr;
+
+public:
+    ScratchBuffer(ScratchArena& arena, size_t size) : size_(size), arena_(&arena) {
+        if (size == 0) {
+            throw std::invalid_argument("Cannot allocate 0 elements");
+        }
+        ptr_ = static_cast<T*>(arena.push(size * sizeof(T), alignof(T), frame_));
+    }
+
+    ScratchBuffer(ScratchBuffer&& other) noexcept
+        : ptr_(other.ptr_), size_(other.size_), frame_(other.frame_), arena_(other.arena_) {
+        other.arena_ = nullptr;
+    }
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(ScratchBuffer&&) = delete;
+
+    ~ScratchBuffer() {
+        if (arena_) {
+            arena_->pop(frame_);
+        }
+    }
+
+    T* get() const { return ptr_; }
+    size_t size() const { return size_; }
+    T* begin() const { return ptr_; }
+    T* end() const { return ptr_ + size_; }
+    T& operator[](size_t idx) const { return ptr_[idx]; }
+};
+
+template <typename T>
+ScratchBuffer<T> thread_scratch(size_t size) {
+    return ScratchBuffer<T>(ScratchArena::local(), size);
+}
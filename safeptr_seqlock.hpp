@@ -0,0 +1,117 @@
+#pragma once
+
+// Seqlock-protected small buffer: one writer, many readers. Readers only load the
+// sequence counter and the data, so they never write a shared cache line; a read
+// that overlaps a write is detected by the counter and retried.
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#include "safeptr.hpp"
+
+namespace safeptr_detail {
+
+// Copies bytes with relaxed atomic word accesses on the shared side, so concurrent
+// reads and writes of the protected buffer are not data races.
+inline void relaxed_load_bytes(void* dst, const void* shared, size_t bytes) {
+#if defined(__GNUC__)
+    const unsigned char* src = static_cast<const unsigned char*>(shared);
+    unsigned char* out = static_cast<unsigned char*>(dst);
+    size_t i = 0;
+    if (reinterpret_cast<uintptr_t>(src) % sizeof(uint64_t) == 0) {
+        for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+            uint64_t word = __atomic_load_n(reinterpret_cast<const uint64_t*>(src + i), __ATOMIC_RELAXED);
+            memcpy(out + i, &word, sizeof(word));
+        }
+    }
+    for (; i < bytes; ++i) {
+        out[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    }
+#else
+    memcpy(dst, shared, bytes);
+#endif
+}
+
+inline void relaxed_store_bytes(void* shared, const void* src, size_t bytes) {
+#if defined(__GNUC__)
+    unsigned char* dst = static_cast<unsigned char*>(shared);
+    const unsigned char* in = static_cast<const unsigned char*>(src);
+    size_t i = 0;
+    if (reinterpret_cast<uintptr_t>(dst) % sizeof(uint64_t) == 0) {
+        for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, in + i, sizeof(word));
+            __atomic_store_n(reinterpret_cast<uint64_t*>(dst + i), word, __ATOMIC_RELAXED);
+        }
+    }
+    for (; i < bytes; ++i) {
+        __atomic_store_n(dst + i, in[i], __ATOMIC_RELAXED);
+    }
+#else
+    memcpy(shared, src, bytes);
+#endif
+}
+
+}  // namespace safeptr_detail
+
+template <typename T>
+class SeqlockSafePointer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock elements must be trivially copyable");
+
+private:
+    alignas(64) std::atomic<uint64_t> seq_{0};  // odd while a write is in progress
+    alignas(64) SafePointer<T> data_;
+
+public:
+    explicit SeqlockSafePointer(size_t size) { data_.callocate(size, sizeof(T)); }
+
+    SeqlockSafePointer(const SeqlockSafePointer&) = delete;
+    SeqlockSafePointer& operator=(const SeqlockSafePointer&) = delete;
+
+    size_t size() const { return data_.size(); }
+
+    // Number of completed writes.
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+    // Writer side; only one thread may call it at a time.
+    void set_values(const T* src_begin, const T* src_end) {
+        if (src_begin == nullptr || src_end == nullptr) {
+            throw std::invalid_argument("Source pointers cannot be null");
+        }
+        if (static_cast<size_t>(src_end - src_begin) > data_.size()) {
+            throw std::invalid_argument("Source range exceeds destination space");
+        }
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        safeptr_detail::relaxed_store_bytes(data_.get(), src_begin, (src_end - src_begin) * sizeof(T));
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Single read attempt; false if it overlapped a write and dst must be discarded.
+    bool try_get_values(T* dst_begin) const {
+        uint64_t before = seq_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        safeptr_detail::relaxed_load_bytes(dst_begin, data_.get(), data_.size() * sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq_.load(std::memory_order_relaxed) == before;
+    }
+
+    // Copies a consistent snapshot of all size() elements, retrying on conflict.
+    void get_values(T* dst_begin) const {
+        if (dst_begin == nullptr) {
+            throw std::invalid_argument("Destination pointer cannot be null");
+        }
+        for (unsigned attempt = 0; !try_get_values(dst_begin); ++attempt) {
+            if (attempt >= 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+// Zero-copy hand-off of SafePointer pages to the kernel. PageBackend gives
+// page-aligned, page-granular anonymous mappings; their pages can be attached to a
+// pipe with vmsplice(SPLICE_F_GIFT) instead of being copied by write(), and moved
+// on to a file with splice(). Once attached, the pipe holds references to the
+// pages and reads them whenever the consumer gets to them, so the buffer must never
+// be written again: both calls consume the SafePointer and unmap its storage after
+// the last page is attached, which drops only our mapping, not the kernel's
+// references. Linux only.
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "safeptr.hpp"
+
+// Anonymous private mappings rounded up to whole pages; reallocation uses mremap.
+class PageBackend : public SafeBackend
+{
+private:
+    size_t page_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    size_t round(size_t bytes) const { return (bytes + page_ - 1) / page_ * page_; }
+
+public:
+    void* allocate(size_t bytes, size_t align) override {
+        if (align > page_) {
+            return nullptr;
+        }
+        void* ptr = mmap(nullptr, round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    void* callocate(size_t bytes, size_t align) override { return allocate(bytes, align); }  // already zero
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        if (!ptr) {
+            return allocate(new_bytes, align);
+        }
+        void* new_ptr = mremap(ptr, round(old_bytes), round(new_bytes), MREMAP_MAYMOVE);
+        return new_ptr == MAP_FAILED ? nullptr : new_ptr;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t) override { munmap(ptr, round(bytes)); }
+
+    size_t page_size() const { return page_; }
+
+    static PageBackend& instance() {
+        static PageBackend backend;
+        return backend;
+    }
+};
+
+namespace safeptr_detail {
+
+inline std::runtime_error splice_error(const char* call) {
+    return std::runtime_error(std::string(call) + " failed: " + strerror(errno));
+}
+
+// Waits until fd is writable; used when a pipe was left in non-blocking mode.
+inline void wait_writable(int fd) {
+    struct pollfd p = {fd, POLLOUT, 0};
+    while (poll(&p, 1, -1) < 0 && errno == EINTR) {
+    }
+}
+
+// Attaches [data, data + bytes) to the pipe, continuing after partial transfers.
+inline void vmsplice_all(int pipe_fd, const unsigned char* data, size_t bytes) {
+    while (bytes > 0) {
+        struct iovec iov = {const_cast<unsigned char*>(data), bytes};
+        ssize_t n = vmsplice(pipe_fd, &iov, 1, SPLICE_F_GIFT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                wait_writable(pipe_fd);
+                continue;
+            }
+            throw splice_error("vmsplice");
+        }
+        data += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+template <typename T>
+const unsigned char* gift_storage(const SafePointer<T>& sptr) {
+    if (!sptr.is_allocated() || sptr.get() == nullptr) {
+        throw std::runtime_error("Cannot splice: memory is not allocated");
+    }
+    if (!dynamic_cast<PageBackend*>(sptr.backend())) {
+        throw std::invalid_argument("Splicing needs storage from a PageBackend");
+    }
+    return reinterpret_cast<const unsigned char*>(sptr.get());
+}
+
+}  // namespace safeptr_detail
+
+// Gifts the buffer's pages to the write end of a pipe and returns the bytes
+// transferred. Blocks while the pipe is full, so a consumer must be reading for
+// buffers larger than the pipe capacity. sptr is consumed, also on failure.
+template <typename T>
+size_t vmsplice_gift(SafePointer<T>&& sptr, int pipe_fd) {
+    SafePointer<T> owned(std::move(sptr));
+    const unsigned char* data = safeptr_detail::gift_storage(owned);
+    size_t bytes = owned.size() * sizeof(T);
+    safeptr_detail::vmsplice_all(pipe_fd, data, bytes);
+    return bytes;
+}
+
+// Moves the buffer's pages to fd at offset through a private pipe (vmsplice, then
+// splice), one pipe capacity at a time. sptr is consumed, also on failure.
+template <typename T>
+size_t splice_to_file(SafePointer<T>&& sptr, int fd, off_t offset) {
+    SafePointer<T> owned(std::move(sptr));
+    const unsigned char* data = safeptr_detail::gift_storage(owned);
+    size_t bytes = owned.size() * sizeof(T);
+
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        throw safeptr_detail::splice_error("pipe2");
+    }
+    fcntl(pipe_fds[1], F_SETPIPE_SZ, 1 << 20);  // best effort; capped by fs.pipe-max-size
+    int capacity = fcntl(pipe_fds[1], F_GETPIPE_SZ);
+    size_t chunk = capacity > 0 ? static_cast<size_t>(capacity) : 65536;
+    loff_t out = offset;
+    try {
+        for (size_t done = 0; done < bytes;) {
+            size_t len = std::min(chunk, bytes - done);
+            safeptr_detail::vmsplice_all(pipe_fds[1], data + done, len);
+            for (size_t left = len; left > 0;) {
+                ssize_t n = splice(pipe_fds[0], nullptr, fd, &out, left, SPLICE_F_MOVE);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    throw safeptr_detail::splice_error("splice");
+                }
+                if (n == 0) {
+                    throw std::runtime_error("splice made no progress");
+                }
+                left -= static_cast<size_t>(n);
+            }
+            done += len;
+        }
+    } catch (...) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        throw;
+    }
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    return bytes;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+// Lookup tables computed at compile time with the ordinary SafePointer API and
+// exposed at run time through non-owning SafePointer<const T> views. A table
+// held in a constexpr variable is emitted into .rodata: no startup loop, and
+// its pages are shared between every process that maps the binary.
+//
+//     constexpr auto kSquares = make_static_table<uint32_t, 256>([](SafePointer<uint32_t>& t) {
+//         for (size_t i = 0; i < t.size(); ++i) {
+//             t.set_value(static_cast<uint32_t>(i * i), i);
+//         }
+//     });
+//     SafePointer<const uint32_t> squares = static_view(kSquares);
+//
+// Constant evaluation needs C++20 (SAFEPTR_CONSTEXPR_ALLOC); before that the
+// same code runs once at dynamic initialisation.
+
+#include <array>
+#include <cstddef>
+
+#include "safeptr.hpp"
+
+// Fills an N-element SafePointer with build(sptr) and returns a copy as std::array.
+template <typename T, size_t N, typename F>
+SAFEPTR_CONSTEXPR std::array<T, N> make_static_table(F build) {
+    static_assert(N > 0, "Static tables cannot be empty");
+    SafePointer<T> sptr(N);
+    build(sptr);
+    std::array<T, N> table{};
+    sptr.get_values(table.data());
+    return table;
+}
+
+template <typename T, size_t N>
+SAFEPTR_CONSTEXPR SafePointer<const T> static_view(const std::array<T, N>& table) {
+    return SafePointer<const T>::view(table.data(), N);
+}
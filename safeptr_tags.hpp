@@ -0,0 +1,234 @@
+#pragma once
+
+// Per-tag memory accounting. A tag ("index", "cache", a tenant id, ...) is a
+// SafeBackend decorator that counts the bytes flowing through it, so a
+// SafePointer is attributed to a tag either explicitly,
+//
+//     SafePointer<char> buf(n, &SafeMemoryTags::get("index"));
+//
+// or implicitly for everything the thread allocates inside a scope,
+//
+//     SafeTagScope scope("request");
+//
+// A buffer stays with the tag it was first allocated under, including when it is
+// reallocated or freed elsewhere. Tagging only adds attribution: a tag allocates
+// from the default backend (pool, guard, trace recorder, ...) in effect when it was
+// created. Registry tags live forever, so they take the process default and never
+// a thread default, which may be a short-lived per-request backend.
+//
+// Counts are kept per CPU like Linux's percpu_counter: updates touch one cache
+// line for the running CPU and fold into the shared total every kBatch bytes.
+// Live bytes are exact once updates quiesce; peak bytes are sampled at folds and
+// reads, so they may miss short spikes of less than one batch per CPU.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "safeptr.hpp"
+#include "safeptr_cpu.hpp"
+#include "safeptr_padded.hpp"
+
+class SafeTagCounter
+{
+private:
+    using Slot = CachePadded<std::atomic<int64_t>>;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<int64_t> total_{0};  // folded slot values
+    mutable std::atomic<int64_t> peak_{0};
+
+    void raise_peak(int64_t value) const {
+        int64_t peak = peak_.load(std::memory_order_relaxed);
+        while (value > peak && !peak_.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    static size_t slot_index() {
+        int cpu = safeptr_detail::current_cpu_id();
+        if (cpu >= 0) {
+            return static_cast<size_t>(cpu);
+        }
+        static thread_local size_t index = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return index;
+    }
+
+public:
+    static constexpr int64_t kBatch = 256 * 1024;
+
+    SafeTagCounter() {
+        size_t slots = 1;
+        while (slots < std::max(1u, std::thread::hardware_concurrency()) && slots < 256) {
+            slots *= 2;
+        }
+        slots_.reset(new Slot[slots]);
+        for (size_t i = 0; i < slots; ++i) {
+            slots_[i].value.store(0, std::memory_order_relaxed);
+        }
+        mask_ = slots - 1;
+    }
+
+    void add(int64_t delta) {
+        std::atomic<int64_t>& slot = slots_[slot_index() & mask_].value;
+        int64_t local = slot.fetch_add(delta, std::memory_order_relaxed) + delta;
+        if (local >= kBatch || local <= -kBatch) {
+            int64_t folded = slot.exchange(0, std::memory_order_relaxed);
+            raise_peak(total_.fetch_add(folded, std::memory_order_relaxed) + folded);
+        }
+    }
+
+    int64_t live() const {
+        int64_t sum = total_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i <= mask_; ++i) {
+            sum += slots_[i].value.load(std::memory_order_relaxed);
+        }
+        sum = std::max<int64_t>(sum, 0);
+        raise_peak(sum);
+        return sum;
+    }
+
+    int64_t peak() const {
+        live();
+        return peak_.load(std::memory_order_relaxed);
+    }
+};
+
+class SafeTagBackend : public SafeBackend
+{
+private:
+    std::string name_;
+    SafeBackend* upstream_;
+    SafeTagCounter counter_;
+
+public:
+    // A null upstream means the default backend at the time of construction.
+    explicit SafeTagBackend(const std::string& name, SafeBackend* upstream = nullptr)
+        : name_(name), upstream_(upstream ? upstream : untagged(SafeBackend::get_default())) {}
+
+    // backend, or the upstream of backend if it is a tag (such as an active
+    // SafeTagScope's), so that every allocation is counted under exactly one tag.
+    static SafeBackend* untagged(SafeBackend& backend) {
+        if (SafeTagBackend* tag = dynamic_cast<SafeTagBackend*>(&backend)) {
+            return tag->upstream_;
+        }
+        return &backend;
+    }
+
+    void* allocate(size_t bytes, size_t align) override {
+        void* ptr = upstream_->allocate(bytes, align);
+        if (ptr) {
+            counter_.add(static_cast<int64_t>(bytes));
+        }
+        return ptr;
+    }
+
+    void* callocate(size_t bytes, size_t align) override {
+        void* ptr = upstream_->callocate(bytes, align);
+        if (ptr) {
+            counter_.add(static_cast<int64_t>(bytes));
+        }
+        return ptr;
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        void* new_ptr = upstream_->reallocate(ptr, old_bytes, new_bytes, align);
+        if (new_ptr) {
+            counter_.add(static_cast<int64_t>(new_bytes) - static_cast<int64_t>(ptr ? old_bytes : 0));
+        }
+        return new_ptr;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        upstream_->deallocate(ptr, bytes, align);
+        counter_.add(-static_cast<int64_t>(bytes));
+    }
+
+    void on_clone(const void* src, const void* dst, size_t bytes) override { upstream_->on_clone(src, dst, bytes); }
+
+    const std::string& name() const { return name_; }
+    SafeBackend* upstream() const { return upstream_; }
+    size_t live_bytes() const { return static_cast<size_t>(counter_.live()); }
+    size_t peak_bytes() const { return static_cast<size_t>(counter_.peak()); }
+};
+
+struct SafeTagStats
+{
+    std::string name;
+    size_t live_bytes;
+    size_t peak_bytes;
+};
+
+// Process-wide tag registry. Tags live until exit, so their backends can be
+// referenced from any SafePointer at any time.
+class SafeMemoryTags
+{
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<SafeTagBackend>> tags;
+    };
+
+    static Registry& registry() {
+        static Registry* registry = new Registry();  // never destroyed, see above
+        return *registry;
+    }
+
+public:
+    // The tag's backend, created over upstream (the process default if null) on
+    // first use. Later calls return the existing backend; they may pass a null
+    // upstream, but naming a different one throws std::invalid_argument.
+    static SafeTagBackend& get(const std::string& name, SafeBackend* upstream = nullptr) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::unique_ptr<SafeTagBackend>& tag = r.tags[name];
+        if (!tag) {
+            if (!upstream) {
+                upstream = SafeTagBackend::untagged(SafeBackend::get_process_default());
+            }
+            tag.reset(new SafeTagBackend(name, upstream));
+        } else if (upstream && upstream != tag->upstream()) {
+            throw std::invalid_argument("Tag '" + name + "' already exists over a different upstream");
+        }
+        return *tag;
+    }
+
+    static std::vector<SafeTagStats> snapshot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::vector<SafeTagStats> stats;
+        for (auto& entry : r.tags) {
+            stats.push_back({entry.first, entry.second->live_bytes(), entry.second->peak_bytes()});
+        }
+        std::sort(stats.begin(), stats.end(),
+                  [](const SafeTagStats& a, const SafeTagStats& b) { return a.name < b.name; });
+        return stats;
+    }
+};
+
+// Attributes SafePointers that first allocate on this thread without an explicit
+// backend to the tag, until the scope ends. Scopes nest; the innermost tag wins.
+class SafeTagScope
+{
+private:
+    SafeBackend* previous_;
+
+public:
+    explicit SafeTagScope(const std::string& name)
+        : previous_(SafeBackend::set_thread_default(&SafeMemoryTags::get(name))) {}
+
+    explicit SafeTagScope(SafeTagBackend& tag) : previous_(SafeBackend::set_thread_default(&tag)) {}
+
+    ~SafeTagScope() { SafeBackend::set_thread_default(previous_); }
+
+    SafeTagScope(const SafeTagScope&) = delete;
+    SafeTagScope& operator=(const SafeTagScope&) = delete;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+// Allocation tracing for allocator tuning. TraceRecorderBackend wraps another
+// backend and appends one fixed-size record per allocate, reallocate, deallocate
+// and clone to a binary file; read_trace() loads a file back and replay_trace()
+// re-runs it against any backend. safeptr_replay.cpp compares backends on a trace.
+//
+// File layout: a 16-byte header ("SPTRACE1", record size, version) followed by
+// SafeTraceEvent records in host byte order, in the order the calls completed.
+// The recorder serialises calls into its upstream backend while tracing, so the
+// buffer ids stay consistent when addresses are reused across threads.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "safeptr.hpp"
+
+struct SafeTraceEvent
+{
+    enum Kind : uint16_t { kAllocate = 1, kReallocate = 2, kDeallocate = 3, kClone = 4 };
+
+    uint64_t time_ns;  // since the recorder was created
+    uint64_t id;       // buffer id, stable across reallocation
+    uint64_t bytes;    // block size after the event; 0 for deallocate
+    uint64_t source;   // kClone: id of the buffer copied from, 0 if untraced
+    uint32_t thread;   // recorder-assigned thread index
+    uint16_t kind;
+    uint16_t align;    // 0 for kClone
+};
+
+static_assert(sizeof(SafeTraceEvent) == 40, "trace records are 40 bytes");
+
+namespace safeptr_detail {
+
+constexpr char trace_magic[8] = {'S', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t trace_version = 1;
+
+// Writes one byte per page so replayed blocks become resident like real buffers.
+inline void touch_pages(void* ptr, size_t from, size_t to) {
+    unsigned char* p = static_cast<unsigned char*>(ptr);
+    for (size_t off = from; off < to; off += 4096) {
+        p[off] = 1;
+    }
+    if (to > from) {
+        p[to - 1] = 1;
+    }
+}
+
+}  // namespace safeptr_detail
+
+class TraceRecorderBackend : public SafeBackend
+{
+private:
+    SafeBackend* upstream_;
+    FILE* file_;
+    std::mutex mutex_;
+    std::unordered_map<const void*, uint64_t> ids_;  // live block -> buffer id
+    uint64_t next_id_ = 1;
+    size_t events_ = 0;
+    std::chrono::steady_clock::time_point start_;
+
+    static uint32_t thread_index() {
+        static std::atomic<uint32_t> next{0};
+        static thread_local uint32_t index = next.fetch_add(1);
+        return index;
+    }
+
+    uint64_t lookup(const void* ptr) const {
+        auto it = ids_.find(ptr);
+        return it == ids_.end() ? 0 : it->second;
+    }
+
+    // Caller holds mutex_.
+    void record(uint16_t kind, uint64_t id, uint64_t bytes, size_t align, uint64_t source = 0) {
+        SafeTraceEvent event;
+        event.time_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+        event.id = id;
+        event.bytes = bytes;
+        event.source = source;
+        event.thread = thread_index();
+        event.kind = kind;
+        event.align = static_cast<uint16_t>(align);
+        fwrite(&event, sizeof(event), 1, file_);
+        ++events_;
+    }
+
+    void* record_allocation(void* ptr, size_t bytes, size_t align) {
+        if (ptr) {
+            uint64_t id = next_id_++;
+            ids_[ptr] = id;
+            record(SafeTraceEvent::kAllocate, id, bytes, align);
+        }
+        return ptr;
+    }
+
+public:
+    explicit TraceRecorderBackend(const std::string& path, SafeBackend* upstream = nullptr)
+        : upstream_(upstream ? upstream : &MallocBackend::instance()), start_(std::chrono::steady_clock::now()) {
+        file_ = fopen(path.c_str(), "wb");
+        if (!file_) {
+            throw std::runtime_error("Cannot open trace file: " + path);
+        }
+        uint32_t header[2] = {static_cast<uint32_t>(sizeof(SafeTraceEvent)), safeptr_detail::trace_version};
+        fwrite(safeptr_detail::trace_magic, sizeof(safeptr_detail::trace_magic), 1, file_);
+        fwrite(header, sizeof(header), 1, file_);
+    }
+
+    ~TraceRecorderBackend() override { fclose(file_); }
+
+    TraceRecorderBackend(const TraceRecorderBackend&) = delete;
+    TraceRecorderBackend& operator=(const TraceRecorderBackend&) = delete;
+
+    void* allocate(size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return record_allocation(upstream_->allocate(bytes, align), bytes, align);
+    }
+
+    void* callocate(size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return record_allocation(upstream_->callocate(bytes, align), bytes, align);
+    }
+
+    void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        void* new_ptr = upstream_->reallocate(ptr, old_bytes, new_bytes, align);
+        if (!new_ptr) {
+            return nullptr;
+        }
+        uint64_t id = lookup(ptr);
+        if (!id) {
+            return record_allocation(new_ptr, new_bytes, align);
+        }
+        ids_.erase(ptr);
+        ids_[new_ptr] = id;
+        record(SafeTraceEvent::kReallocate, id, new_bytes, align);
+        return new_ptr;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t id = lookup(ptr);
+        if (id) {
+            ids_.erase(ptr);
+            record(SafeTraceEvent::kDeallocate, id, 0, align);
+        }
+        upstream_->deallocate(ptr, bytes, align);
+    }
+
+    void on_clone(const void* src, const void* dst, size_t bytes) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t id = lookup(dst);
+            if (id) {
+                record(SafeTraceEvent::kClone, id, bytes, 0, lookup(src));
+            }
+        }
+        upstream_->on_clone(src, dst, bytes);
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fflush(file_);
+    }
+
+    size_t events() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_;
+    }
+};
+
+inline std::vector<SafeTraceEvent> read_trace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    char magic[sizeof(safeptr_detail::trace_magic)];
+    uint32_t header[2];
+    bool valid = fread(magic, sizeof(magic), 1, file) == 1 && fread(header, sizeof(header), 1, file) == 1 &&
+                 memcmp(magic, safeptr_detail::trace_magic, sizeof(magic)) == 0 &&
+                 header[0] == sizeof(SafeTraceEvent) && header[1] == safeptr_detail::trace_version;
+    std::vector<SafeTraceEvent> events;
+    SafeTraceEvent event;
+    while (valid && fread(&event, sizeof(event), 1, file) == 1) {
+        events.push_back(event);
+    }
+    fclose(file);
+    if (!valid) {
+        throw std::runtime_error("Not a SafePointer trace file: " + path);
+    }
+    return events;
+}
+
+struct SafeReplayStats
+{
+    double seconds = 0;          // time spent in the backend and first-touching pages
+    size_t events = 0;
+    size_t failures = 0;         // allocations the backend refused
+    size_t peak_live_bytes = 0;  // requested bytes, the lower bound for any footprint
+};
+
+// Re-runs a trace on the calling thread. Blocks are touched page by page when they
+// are allocated or grown, clones are copied, and blocks still live at the end of the
+// trace are freed afterwards (not timed).
+inline SafeReplayStats replay_trace(const std::vector<SafeTraceEvent>& events, SafeBackend& backend) {
+    struct Block {
+        void* ptr;
+        size_t bytes;
+        size_t align;
+    };
+    std::unordered_map<uint64_t, Block> live;
+    SafeReplayStats stats;
+    size_t live_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const SafeTraceEvent& e : events) {
+        ++stats.events;
+        size_t align = e.align ? e.align : alignof(std::max_align_t);
+        auto it = live.find(e.id);
+        switch (e.kind) {
+        case SafeTraceEvent::kAllocate: {
+            if (it != live.end()) {
+                break;
+            }
+            void* ptr = backend.allocate(e.bytes, align);
+            if (!ptr) {
+                ++stats.failures;
+                break;
+            }
+            safeptr_detail::touch_pages(ptr, 0, e.bytes);
+            live[e.id] = {ptr, static_cast<size_t>(e.bytes), align};
+            live_bytes += e.bytes;
+            break;
+        }
+        case SafeTraceEvent::kReallocate: {
+            if (it == live.end()) {
+                break;
+            }
+            Block& block = it->second;
+            void* ptr = backend.reallocate(block.ptr, block.bytes, e.bytes, block.align);
+            if (!ptr) {
+                ++stats.failures;
+                break;
+            }
+            safeptr_detail::touch_pages(ptr, std::min<size_t>(block.bytes, e.bytes), e.bytes);
+            live_bytes = live_bytes - block.bytes + e.bytes;
+            block.ptr = ptr;
+            block.bytes = e.bytes;
+            break;
+        }
+        case SafeTraceEvent::kDeallocate:
+            if (it != live.end()) {
+                backend.deallocate(it->second.ptr, it->second.bytes, it->second.align);
+                live_bytes -= it->second.bytes;
+                live.erase(it);
+            }
+            break;
+        case SafeTraceEvent::kClone: {
+            auto src = live.find(e.source);
+            if (it != live.end() && src != live.end()) {
+                memcpy(it->second.ptr, src->second.ptr, std::min(it->second.bytes, src->second.bytes));
+            }
+            break;
+        }
+        }
+        stats.peak_live_bytes = std::max(stats.peak_live_bytes, live_bytes);
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto& entry : live) {
+        backend.deallocate(entry.second.ptr, entry.second.bytes, entry.second.align);
+    }
+    return stats;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Wait-free triple buffer of equally sized SafePointers for one producer and one
+// consumer. The producer always owns a back buffer to fill, the consumer always
+// owns a front buffer to read, and completed frames are handed over by exchanging
+// the index of the shared middle buffer. No frame is ever copied.
+
+#include <atomic>
+#include <cstdint>
+
+#include "safeptr.hpp"
+
+template <typename T>
+class TripleBuffer
+{
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;  // middle holds a frame the consumer has not seen
+
+    SafePointer<T> buffers_[3];
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t back_ = 0;   // producer only
+    alignas(64) uint8_t front_ = 2;  // consumer only
+
+public:
+    explicit TripleBuffer(size_t size) {
+        for (SafePointer<T>& buffer : buffers_) {
+            buffer.allocate(size);
+        }
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    size_t size() const { return buffers_[0].size(); }
+
+    // Producer: buffer to fill for the next frame.
+    SafePointer<T>& write_buffer() { return buffers_[back_]; }
+
+    // Producer: hands the filled back buffer over and takes the middle one in exchange.
+    // An unconsumed older frame in the middle is dropped.
+    void publish() {
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Consumer: swaps in the latest published frame; false if nothing new arrived.
+    bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    // Consumer: latest frame as of the last update().
+    const SafePointer<T>& read_buffer() const { return buffers_[front_]; }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+// Work-stealing thread pool behind the parallel SafePointer algorithms
+// (safeptr_parallel.hpp) and the parallel tier of the copy engine. Independent of
+// SafePointer, so the core headers can use it.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Loop {
+        std::function<void(size_t, size_t)> body;
+        size_t grain;
+        std::atomic<size_t> remaining;  // elements not yet processed
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    // One deque per worker plus a shared injection deque for outside threads.
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+
+    struct ThreadSlot {
+        const WorkStealingPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static ThreadSlot& slot() {
+        static thread_local ThreadSlot s;
+        return s;
+    }
+
+    size_t injection_index() const { return threads_.size(); }
+
+    size_t local_index() const {
+        const ThreadSlot& s = slot();
+        return s.pool == this ? s.index : injection_index();
+    }
+
+    void push(Task task) {
+        Queue& q = *queues_[local_index()];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+            sleep_cv_.notify_one();
+        }
+    }
+
+    // Owner pops newest work from the back; thieves take the oldest (largest) from the front.
+    bool try_run_one(size_t self) {
+        Task task;
+        {
+            Queue& q = *queues_[self];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; !task && i < queues_.size(); ++i) {
+            Queue& q = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        queued_.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    void worker_main(size_t index) {
+        slot().pool = this;
+        slot().index = index;
+        while (!stop_.load()) {
+            if (try_run_one(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [this] { return stop_.load() || queued_.load() > 0; });
+            sleepers_.fetch_sub(1);
+        }
+    }
+
+    void run_range(Loop* loop, size_t lo, size_t hi) {
+        while (hi - lo > loop->grain) {
+            size_t mid = lo + (hi - lo) / 2;
+            push([this, loop, mid, hi] { run_range(loop, mid, hi); });
+            hi = mid;
+        }
+        try {
+            loop->body(lo, hi);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(loop->error_mutex);
+            if (!loop->error) {
+                loop->error = std::current_exception();
+            }
+        }
+        loop->remaining.fetch_sub(hi - lo);
+    }
+
+public:
+    explicit WorkStealingPool(size_t threads) {
+        for (size_t i = 0; i <= threads; ++i) {
+            queues_.push_back(std::unique_ptr<Queue>(new Queue));
+        }
+        threads_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&WorkStealingPool::worker_main, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_.store(true);
+        }
+        sleep_cv_.notify_all();
+        for (std::thread& t : threads_) {
+            t.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Shared pool; the calling thread helps, so it spawns one worker fewer than the core count.
+    static WorkStealingPool& instance() {
+        static WorkStealingPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    size_t size() const { return threads_.size(); }
+
+    // Calls body(lo, hi) over disjoint subranges of [begin, end) of at most `grain` elements.
+    // Ranges of up to two grains, or a pool without workers, run inline on the caller.
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+        if (end <= begin) {
+            return;
+        }
+        if (grain == 0) {
+            throw std::invalid_argument("Grain size cannot be 0");
+        }
+        if (threads_.empty() || end - begin <= 2 * grain) {
+            body(begin, end);
+            return;
+        }
+        Loop loop;
+        loop.body = [&body](size_t lo, size_t hi) { body(lo, hi); };
+        loop.grain = grain;
+        loop.remaining.store(end - begin);
+        run_range(&loop, begin, end);
+        size_t self = local_index();
+        while (loop.remaining.load(std::memory_order_acquire) != 0) {
+            if (!try_run_one(self)) {
+                std::this_thread::yield();
+            }
+        }
+        if (loop.error) {
+            std::rethrow_exception(loop.error);
+        }
+    }
+};
@@ -1,6 +1,36 @@
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
 #include "safeptr.hpp"
+#include "safeptr_allocator.hpp"
+#include "safeptr_arena.hpp"
+#include "safeptr_chain.hpp"
+#include "safeptr_coro.hpp"
+#include "safeptr_deferred.hpp"
+#include "safeptr_expr.hpp"
+#include "safeptr_guard.hpp"
+#include "safeptr_half.hpp"
+#include "safeptr_incremental.hpp"
+#include "safeptr_layout.hpp"
+#include "safeptr_padded.hpp"
+#include "safeptr_parallel.hpp"
+#include "safeptr_percpu.hpp"
+#include "safeptr_pool.hpp"
+#include "safeptr_scratch.hpp"
+#include "safeptr_seqlock.hpp"
+#include "safeptr_splice.hpp"
+#include "safeptr_static.hpp"
+#include "safeptr_tags.hpp"
+#include "safeptr_trace.hpp"
+#include "safeptr_triple.hpp"
 
 void test_allocate_and_deallocate() {
     SafePointer<int> sptr;
@@ -149,6 +179,1272 @@ void test_clear() {
     }
 }
 
+void test_parallel() {
+    WorkStealingPool pool(3);
+    SafePointer<int> sptr;
+    sptr.allocate(100000);
+
+    // Generate by index, then transform and update in place across workers
+    parallel_generate(pool, sptr, [](size_t i) { return static_cast<int>(i); }, 1000);
+    SafePointer<long> squares;
+    parallel_transform(pool, sptr, squares, [](int v) { return static_cast<long>(v) * v; }, 1000);
+    parallel_for_each(pool, sptr, [](int& v) { v += 1; }, 1000);
+    assert(squares.size() == sptr.size());
+    for (size_t i = 0; i < sptr.size(); ++i) {
+        assert(sptr.get()[i] == static_cast<int>(i) + 1);
+        assert(squares.get()[i] == static_cast<long>(i) * static_cast<long>(i));
+    }
+
+    // Small ranges run sequentially on the shared pool
+    SafePointer<int> small;
+    small.allocate(8);
+    parallel_generate(small, [] { return 7; });
+    for (size_t i = 0; i < small.size(); ++i) {
+        assert(small.get()[i] == 7);
+    }
+
+    // Exceptions thrown by the body reach the caller
+    bool thrown = false;
+    try {
+        parallel_for_each(pool, sptr, [](int& v) { if (v == 5000) throw std::runtime_error("boom"); }, 100);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_expressions() {
+    SafePointer<float> a(6), b(6), c(6), out;
+    for (size_t i = 0; i < a.size(); ++i) {
+        a.set_value(static_cast<float>(i) - 3.0f, i);
+        b.set_value(2.0f, i);
+        c.set_value(1.0f, i);
+    }
+
+    // Fused evaluation allocates out once and applies the whole tree per element
+    out = a * b + c;
+    assert(out.size() == a.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        assert(out.get()[i] == a.get()[i] * 2.0f + 1.0f);
+    }
+
+    out = max(a, 0);
+    for (size_t i = 0; i < out.size(); ++i) {
+        assert(out.get()[i] == (a.get()[i] > 0.0f ? a.get()[i] : 0.0f));
+    }
+
+    // Operands may alias the destination
+    a = abs(-a) / 2.0f - min(b, c);
+    assert(a.get()[0] == 0.5f);
+
+    SafePointer<double> big(50000), sum;
+    big.fill(1.5);
+    WorkStealingPool pool(2);
+    parallel_assign(pool, sum, big * 2.0 + big, 1000);
+    for (size_t i = 0; i < sum.size(); ++i) {
+        assert(sum.get()[i] == 4.5);
+    }
+
+    bool thrown = false;
+    try {
+        SafePointer<float> shorter(3);
+        out = a + shorter;
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+void test_coroutines() {
+    SafePointer<int> sptr;
+    sptr.allocate(10);
+    sptr.fill(3);
+
+    // Chunked traversal yields consecutive spans covering the buffer
+    size_t chunks = 0, total = 0;
+    for (std::span<int> span : chunked(sptr, 4)) {
+        ++chunks;
+        total += span.size();
+    }
+    assert(chunks == 3);
+    assert(total == sptr.size());
+
+    // Async operations interleave with other work queued on the same loop
+    SafeEventLoop loop;
+    SafePointer<int> big;
+    big.allocate(1000);
+    auto filled = async_fill(loop, big, 9, 100 * sizeof(int));
+    filled.start();
+    assert(!filled.done());
+    loop.run();
+    assert(filled.done());
+    filled.get();
+
+    auto cloned = async_clone(loop, big, 100 * sizeof(int));
+    cloned.start();
+    loop.run();
+    SafePointer<int> copy = cloned.get();
+    assert(copy.size() == big.size());
+    assert(copy.get() != big.get());
+    for (size_t i = 0; i < copy.size(); ++i) {
+        assert(copy.get()[i] == 9);
+    }
+
+    // Tasks compose with co_await
+    SafePointer<int> target;
+    auto pipeline = [](SafeEventLoop& ex, SafePointer<int>& dst, const SafePointer<int>& src) -> SafeTask<> {
+        co_await async_copy(ex, dst, src, src.size(), 64);
+        co_await async_fill(ex, dst, 1, 64);
+    };
+    auto chained = pipeline(loop, target, big);
+    chained.start();
+    loop.run();
+    chained.get();
+    assert(target.size() == big.size());
+    assert(target.get()[999] == 1);
+}
+#endif
+
+void test_incremental() {
+    SafePointer<int> src;
+    src.allocate(1000);
+    for (size_t i = 0; i < src.size(); ++i) {
+        src.set_value(i, i);
+    }
+
+    // Byte budgets bound the work done per step
+    IncrementalClone<int> clone(src);
+    SafeProgress progress = clone.step(SafeBudget::bytes(400 * sizeof(int)));
+    assert(progress.done == 400);
+    assert(!progress.finished());
+    size_t steps = 1;
+    while (!clone.step(SafeBudget::bytes(400 * sizeof(int))).finished()) {
+        ++steps;
+    }
+    assert(steps == 2);
+    SafePointer<int> cloned = clone.result();
+    for (size_t i = 0; i < cloned.size(); ++i) {
+        assert(cloned.get()[i] == static_cast<int>(i));
+    }
+
+    SafePointer<int> dst;
+    IncrementalCopy<int> copy(dst, src, 500);
+    while (!copy.step(SafeBudget::time(std::chrono::milliseconds(1))).finished()) {
+    }
+    assert(dst.size() == 500 && dst.get()[499] == 499);
+
+    IncrementalFill<int> fill(dst, 5);
+    while (!fill.step(SafeBudget::bytes(64)).finished()) {
+    }
+    assert(dst.get()[0] == 5 && dst.get()[499] == 5);
+
+    // The target keeps its old buffer until the final step swaps the new one in
+    IncrementalResize<int> resize(src, 2000);
+    resize.step(SafeBudget::bytes(100 * sizeof(int)));
+    assert(src.size() == 1000);
+    while (!resize.step(SafeBudget::bytes(100 * sizeof(int))).finished()) {
+    }
+    assert(src.size() == 2000);
+    assert(src.get()[999] == 999);
+
+    // Copying into a used destination starts from a fresh buffer
+    IncrementalCopy<int> recopy(dst, src, 10);
+    recopy.step(SafeBudget::bytes(1 << 20));
+    assert(dst.size() == 10 && dst.get()[9] == 9);
+
+    // Resized pointers stay with their backend
+    PoolBackend pool;
+    SafePointer<int> pooled(100, &pool);
+    pooled.set_value(7, 99);
+    IncrementalResize<int> grow(pooled, 5000);
+    while (!grow.step(SafeBudget::bytes(64)).finished()) {
+    }
+    assert(pooled.backend() == &pool);
+    assert(pooled.size() == 5000 && pooled.get()[99] == 7);
+    SafePointer<int> empty(&pool);
+    IncrementalResize<int> first(empty, 16);
+    assert(first.progress().finished() && empty.size() == 16 && empty.backend() == &pool);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+static char* foreign_page = nullptr;
+
+// Stands in for an unrelated handler that recovers from its own faults.
+static void recover_foreign_fault(int, siginfo_t* info, void*) {
+    if (static_cast<char*>(info->si_addr) == foreign_page) {
+        mprotect(foreign_page, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_READ | PROT_WRITE);
+    } else {
+        signal(SIGSEGV, SIG_DFL);
+    }
+}
+
+void test_guard_sampling() {
+    SafeGuardOptions options;
+    options.sample_rate = 1;
+    options.slots = 2;
+    SampledGuardBackend guard(options);
+
+    // Sampled blocks end exactly at a guard page and behave like ordinary storage
+    SafePointer<char> sptr(100, &guard);
+    assert(guard.owns(sptr.get()));
+    assert(guard.sampled_count() == 1);
+    sptr.fill('x');
+    sptr.resize(200);
+    assert(guard.owns(sptr.get()));
+    assert(sptr.get()[99] == 'x');
+    sptr.deallocate();
+
+    // An overflow by one element faults and is reported before the process dies
+    int pipefd[2];
+    assert(pipe(pipefd) == 0);
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(pipefd[1], STDERR_FILENO);
+        guard.install_fault_handler();
+        SafePointer<char> victim(64, &guard);
+        volatile char* p = victim.get();
+        p[64] = 'x';
+        _exit(0);
+    }
+    close(pipefd[1]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    char report[512] = {};
+    ssize_t n = read(pipefd[0], report, sizeof(report) - 1);
+    close(pipefd[0]);
+    assert(!WIFEXITED(status) || WEXITSTATUS(status) != 0);  // sanitizers may turn the fault into an exit
+    assert(n > 0 && strstr(report, "buffer overflow") != nullptr);
+
+    // A fault outside the region goes to the previous handler; detection stays on
+    assert(pipe(pipefd) == 0);
+    pid = fork();
+    if (pid == 0) {
+        dup2(pipefd[1], STDERR_FILENO);
+        struct sigaction recover = {};
+        recover.sa_sigaction = recover_foreign_fault;
+        recover.sa_flags = SA_SIGINFO;
+        sigaction(SIGSEGV, &recover, nullptr);
+        guard.install_fault_handler();
+        foreign_page = static_cast<char*>(
+            mmap(nullptr, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        *reinterpret_cast<volatile char*>(foreign_page) = 'x';
+        SafePointer<char> victim(64, &guard);
+        volatile char* p = victim.get();
+        p[64] = 'x';
+        _exit(0);
+    }
+    close(pipefd[1]);
+    waitpid(pid, &status, 0);
+    memset(report, 0, sizeof(report));
+    n = read(pipefd[0], report, sizeof(report) - 1);
+    close(pipefd[0]);
+    assert(!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+    assert(n > 0 && strstr(report, "buffer overflow") != nullptr);
+}
+#endif
+
+void test_seqlock() {
+    SeqlockSafePointer<long> snapshot(8);
+    long values[8];
+    snapshot.get_values(values);
+    assert(values[0] == 0 && values[7] == 0);
+
+    // Readers only ever observe whole frames written by the writer
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        long frame[8];
+        for (long v = 1; v <= 20000; ++v) {
+            std::fill(frame, frame + 8, v);
+            snapshot.set_values(frame, frame + 8);
+        }
+        done = true;
+    });
+    long last = 0;
+    while (!done) {
+        snapshot.get_values(values);
+        for (size_t i = 1; i < 8; ++i) {
+            assert(values[i] == values[0]);
+        }
+        assert(values[0] >= last);
+        last = values[0];
+    }
+    writer.join();
+    snapshot.get_values(values);
+    assert(values[7] == 20000);
+    assert(snapshot.version() == 20000);
+}
+
+void test_padded() {
+    PaddedSafePointer<uint64_t> counters(4);
+    counters.fill(0);
+
+    // Each element sits on its own aligned cache line
+    assert(PaddedSafePointer<uint64_t>::slot_size() == SAFEPTR_CACHE_LINE);
+    assert(reinterpret_cast<uintptr_t>(&counters[0]) % SAFEPTR_CACHE_LINE == 0);
+    assert(reinterpret_cast<char*>(&counters[1]) - reinterpret_cast<char*>(&counters[0]) == SAFEPTR_CACHE_LINE);
+
+    std::thread workers[4];
+    for (size_t t = 0; t < 4; ++t) {
+        workers[t] = std::thread([&counters, t] {
+            for (int i = 0; i < 1000; ++i) {
+                ++counters[t];
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    uint64_t total = 0;
+    for (uint64_t count : counters) {
+        total += count;
+    }
+    assert(total == 4000);
+
+    counters.resize(8);
+    assert(counters.size() == 8 && counters[3] == 1000);
+    assert(reinterpret_cast<uintptr_t>(&counters[0]) % SAFEPTR_CACHE_LINE == 0);
+
+    // Iterators satisfy random access algorithms
+    for (size_t i = 4; i < 8; ++i) {
+        counters[i] = i;
+    }
+    auto first = counters.begin();
+    auto last = counters.end();
+    assert(last > first && first <= first && last >= first + 1 && 2 + first == first + 2);
+    std::sort(first, last);
+    assert(counters[0] == 4 && counters[3] == 7 && counters[7] == 1000);
+}
+
+void test_scratch() {
+    ScratchArena& arena = ScratchArena::local();
+    {
+        ScratchBuffer<int> outer = thread_scratch<int>(100);
+        std::fill(outer.begin(), outer.end(), 1);
+        {
+            // Nested scopes stack on top without disturbing the outer buffer
+            ScratchBuffer<double> inner = thread_scratch<double>(50000);
+            assert(arena.depth() == 2);
+            assert(reinterpret_cast<uintptr_t>(inner.get()) % alignof(double) == 0);
+            inner[49999] = 2.0;
+        }
+        assert(arena.depth() == 1);
+        assert(outer[99] == 1);
+    }
+    assert(arena.depth() == 0);
+
+    // The grown storage is consolidated and reused by later calls
+    size_t capacity = arena.capacity();
+    {
+        ScratchBuffer<int> again = thread_scratch<int>(100);
+        ScratchBuffer<double> big = thread_scratch<double>(50000);
+        assert(arena.capacity() == capacity);
+        assert(reinterpret_cast<char*>(big.get()) > reinterpret_cast<char*>(again.get()));
+    }
+    assert(arena.capacity() == capacity);
+
+    // A block that cannot be allocated leaves no frame behind
+    struct FailingBackend : SafeBackend {
+        void* allocate(size_t, size_t) override { return nullptr; }
+        void deallocate(void*, size_t, size_t) override {}
+    } failing;
+    {
+        ScratchBuffer<int> held = thread_scratch<int>(10);
+        SafeBackend* previous = SafeBackend::set_thread_default(&failing);
+        bool thrown = false;
+        try {
+            ScratchBuffer<char> huge = thread_scratch<char>(4 * capacity);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        SafeBackend::set_thread_default(previous);
+        assert(thrown && arena.depth() == 1);
+    }
+    assert(arena.depth() == 0);
+    ScratchBuffer<char> after = thread_scratch<char>(4 * capacity);
+    assert(arena.depth() == 1);
+}
+
+void test_triple_buffer() {
+    TripleBuffer<int> frames(16);
+    assert(!frames.update());
+
+    // The consumer sees the newest published frame; older unread ones are skipped
+    frames.write_buffer().fill(1);
+    frames.publish();
+    frames.write_buffer().fill(2);
+    frames.publish();
+    assert(frames.update());
+    assert(frames.read_buffer().get()[0] == 2);
+    assert(!frames.update());
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int frame = 3; frame <= 10000; ++frame) {
+            frames.write_buffer().fill(frame);
+            frames.publish();
+        }
+        done = true;
+    });
+    int last = 2;
+    while (!done) {
+        if (frames.update()) {
+            const SafePointer<int>& frame = frames.read_buffer();
+            assert(frame.get()[0] == frame.get()[15]);
+            assert(frame.get()[0] > last);
+            last = frame.get()[0];
+        }
+    }
+    producer.join();
+    frames.update();
+    assert(frames.read_buffer().get()[0] == 10000);
+}
+
+void test_convert() {
+    SafePointer<float> floats(5);
+    const float values[] = {-1.5f, 0.25f, 2.5f, 1e10f, -1e10f};
+    floats.set_values(values, values + 5);
+
+    SafePointer<double> doubles = floats.convert_to<double>();
+    assert(doubles.size() == 5 && doubles.get()[1] == 0.25);
+
+    // Float to integer rounds to nearest even and saturates
+    SafePointer<int32_t> ints = floats.convert_to<int32_t>();
+    assert(ints.get()[0] == -2 && ints.get()[2] == 2);
+    assert(ints.get()[3] == INT32_MAX && ints.get()[4] == INT32_MIN);
+
+    // NaN becomes 0
+    SafePointer<double> nans(3);
+    nans.fill(std::numeric_limits<double>::quiet_NaN());
+    SafePointer<int16_t> zeros = nans.convert_to<int16_t>();
+    assert(zeros.get()[0] == 0 && zeros.get()[2] == 0);
+    assert(floats.convert_to<int8_t>(std::numeric_limits<float>::quiet_NaN()).get()[1] == 0);
+
+    // Integer narrowing saturates, widening is exact
+    SafePointer<int16_t> shorts;
+    ints.convert_into(shorts);
+    assert(shorts.get()[3] == INT16_MAX && shorts.get()[4] == INT16_MIN && shorts.get()[0] == -2);
+    SafePointer<uint8_t> bytes = ints.convert_to<uint8_t>();
+    assert(bytes.get()[0] == 0 && bytes.get()[3] == 255);
+    SafePointer<int64_t> longs = shorts.convert_to<int64_t>();
+    assert(longs.get()[4] == INT16_MIN);
+
+    // Scaling applies in both directions between fixed and floating point
+    SafePointer<float> scaled = shorts.convert_to<float>(1.0 / 32768);
+    assert(scaled.get()[4] == -1.0f);
+    SafePointer<int16_t> fixed = scaled.convert_to<int16_t>(32768.0);
+    assert(fixed.get()[4] == INT16_MIN && fixed.get()[3] == INT16_MAX);
+
+    SafePointer<int32_t> big(100000);
+    parallel_generate(big, [](size_t i) { return static_cast<int32_t>(i); });
+    SafePointer<float> bigf;
+    WorkStealingPool pool(2);
+    parallel_convert_into(pool, big, bigf, 0.5, 1000);
+    assert(bigf.get()[99999] == 49999.5f);
+}
+
+void test_half() {
+    // Every finite half value survives a round trip through float
+    for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+        half h = half::from_bits(static_cast<uint16_t>(bits));
+        if ((bits & 0x7c00) == 0x7c00 && (bits & 0x3ff) != 0) {
+            continue;  // NaN payloads are only required to stay NaN
+        }
+        assert(half(static_cast<float>(h)).bits == bits);
+    }
+    assert(half(65519.0f).bits == 0x7bff);
+    assert(half(65520.0f).bits == 0x7c00);
+    assert(half(5.9604645e-8f).bits == 0x0001);
+    assert(bfloat16(1.0f).bits == 0x3f80);
+    assert(bfloat16(1.00390625f).bits == 0x3f80);  // tie rounds to even
+
+    // Storage, fill, bulk conversion and reductions
+    SafePointer<half> weights(1000);
+    weights.fill(0.5f);
+    assert(reduce_sum(weights) == 500.0f);
+    SafePointer<float> wide = weights.convert_to<float>(2.0);
+    assert(wide.get()[999] == 1.0f);
+
+    SafePointer<bfloat16> narrow = wide.convert_to<bfloat16>();
+    assert(reduce_dot(narrow, narrow) == 1000.0f);
+    SafePointer<half> back = narrow.convert_to<half>();
+    assert(static_cast<float>(back.get()[0]) == 1.0f);
+    SafePointer<int32_t> ints = back.convert_to<int32_t>(3.0);
+    assert(ints.get()[10] == 3);
+
+    float row[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    store_narrowed(weights, 996, row, 4);
+    float loaded[4];
+    load_widened(weights, 996, loaded, 4);
+    assert(loaded[3] == 4.0f);
+}
+
+void test_layout() {
+    // Odd shapes exercise the SIMD tiles, their tails and the recursive splits
+    const size_t rows = 75, cols = 130;
+    SafePointer<float> matrix(rows * cols), transposed, parallel;
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        matrix.set_value(static_cast<float>(i), i);
+    }
+    transpose(matrix, transposed, rows, cols);
+    WorkStealingPool pool(2);
+    parallel_transpose(pool, matrix, parallel, rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            assert(transposed.get()[j * rows + i] == matrix.get()[i * cols + j]);
+            assert(parallel.get()[j * rows + i] == matrix.get()[i * cols + j]);
+        }
+    }
+
+    SafePointer<double> square(67 * 67);
+    for (size_t i = 0; i < square.size(); ++i) {
+        square.set_value(static_cast<double>(i), i);
+    }
+    transpose_in_place(square, 67);
+    assert(square.get()[1] == 67.0 && square.get()[67] == 1.0 && square.get()[66 * 67 + 65] == 65 * 67 + 66);
+
+    // Three-field records repacked to one run per field and back
+    SafePointer<int> records(3 * 4), fields, again;
+    for (size_t i = 0; i < records.size(); ++i) {
+        records.set_value(static_cast<int>(i), i);
+    }
+    aos_to_soa(records, fields, 3);
+    assert(fields.get()[0] == 0 && fields.get()[1] == 3 && fields.get()[4] == 1);
+    soa_to_aos(fields, again, 3);
+    for (size_t i = 0; i < again.size(); ++i) {
+        assert(again.get()[i] == static_cast<int>(i));
+    }
+}
+
+void test_copy_engine() {
+    // Every tier must produce an exact copy, including odd sizes and offsets
+    SafeCopyConfig saved = SafeCopyEngine::config();
+    SafeCopyConfig tiers = saved;
+    tiers.rep_movsb_min = 1024;
+    tiers.nontemporal_min = 64 * 1024;
+    tiers.parallel_min = 256 * 1024;
+    tiers.threads = 3;
+    SafeCopyEngine::set_config(tiers);
+    assert(SafeCopyEngine::config().nontemporal_min == 64 * 1024);
+
+    const size_t sizes[] = {0, 1, 3, 7, 15, 31, 63, 64, 65, 1000, 5000, 100000, 300001};
+    SafePointer<unsigned char> src(300008);
+    for (size_t i = 0; i < src.size(); ++i) {
+        src.set_value(static_cast<unsigned char>(i * 7 + 3), i);
+    }
+    for (size_t n : sizes) {
+        SafePointer<unsigned char> dst(n + 8);
+        dst.fill(0);
+        SafeCopyEngine::copy(dst.get() + 1, src.get() + 5, n);
+        assert(dst.get()[0] == 0 && dst.get()[n + 1] == 0);
+        assert(memcmp(dst.get() + 1, src.get() + 5, n) == 0);
+    }
+
+    SafePointer<unsigned char> cloned = src.clone();
+    assert(memcmp(cloned.get(), src.get(), src.size()) == 0);
+    SafeCopyEngine::set_config(saved);
+}
+
+void test_move_within() {
+    SafePointer<int> sptr(8);
+    for (size_t i = 0; i < sptr.size(); ++i) {
+        sptr.set_value(static_cast<int>(i), i);
+    }
+
+    // Overlapping forward move keeps the source values intact while copying
+    sptr.move_within(0, 2, 5);
+    const int moved[] = {0, 1, 0, 1, 2, 3, 4, 7};
+    assert(memcmp(sptr.get(), moved, sizeof(moved)) == 0);
+
+    // set_values with a source inside the buffer is now overlap-safe as well
+    sptr.set_values(sptr.get() + 2, sptr.get() + 7, sptr.get() + 3);
+    const int set[] = {0, 1, 0, 0, 1, 2, 3, 4};
+    assert(memcmp(sptr.get(), set, sizeof(set)) == 0);
+
+    sptr.rotate(3);
+    const int rotated[] = {0, 1, 2, 3, 4, 0, 1, 0};
+    assert(memcmp(sptr.get(), rotated, sizeof(rotated)) == 0);
+
+    sptr.shift_left(2, -1);
+    const int left[] = {2, 3, 4, 0, 1, 0, -1, -1};
+    assert(memcmp(sptr.get(), left, sizeof(left)) == 0);
+
+    sptr.shift_right(3);
+    const int right[] = {0, 0, 0, 2, 3, 4, 0, 1};
+    assert(memcmp(sptr.get(), right, sizeof(right)) == 0);
+
+    bool thrown = false;
+    try {
+        sptr.move_within(4, 0, 5);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+SAFEPTR_CONSTEXPR std::array<uint32_t, 64> build_squares() {
+    return make_static_table<uint32_t, 64>([](SafePointer<uint32_t>& t) {
+        for (size_t i = 0; i < t.size(); ++i) {
+            t.set_value(static_cast<uint32_t>(i * i), i);
+        }
+    });
+}
+
+#if SAFEPTR_CONSTEXPR_ALLOC
+constexpr std::array<uint32_t, 64> kSquares = build_squares();
+static_assert(kSquares[63] == 63 * 63, "table is built at compile time");
+
+constexpr uint32_t constexpr_roundtrip() {
+    SafePointer<uint32_t> a(4);
+    a.fill(3);
+    SafePointer<uint32_t> b = a.clone();
+    b.reallocate(6);
+    b.set_value(7, 5);
+    b.set_values(b.begin(), b.begin() + 3, b.begin() + 1);
+    SafePointer<uint32_t> c;
+    c.copy(b, 6);
+    uint32_t sum = 0;
+    for (uint32_t v : c) {
+        sum += v;
+    }
+    return sum;  // 3 * 4 + 0 + 7
+}
+static_assert(constexpr_roundtrip() == 19, "allocation, fill and copy are constexpr");
+#else
+const std::array<uint32_t, 64> kSquares = build_squares();
+#endif
+
+void test_static_table() {
+    SafePointer<const uint32_t> view = static_view(kSquares);
+    assert(view.is_allocated());
+    assert(!view.is_owning());
+    assert(view.size() == 64);
+    assert(view.get() == kSquares.data());
+    assert(view.get()[0] == 0 && view.get()[10] == 100);
+
+    // Views cannot grow; copies become ordinary owning buffers
+    bool thrown = false;
+    try {
+        view.resize(128);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    SafePointer<const uint32_t> copy = view;
+    assert(copy.is_owning());
+    assert(copy.get() != kSquares.data() && copy.get()[63] == 63 * 63);
+
+    SafePointer<const uint32_t> moved = std::move(view);
+    assert(!moved.is_owning() && !view.is_allocated());
+    moved.deallocate();
+    assert(kSquares[5] == 25);
+}
+
+void test_operator_new_backend() {
+    OperatorNewBackend& backend = OperatorNewBackend::instance();
+    SafePointer<int> a(100, &backend);
+    a.fill(5);
+    a.reallocate(1000);
+    assert(a.backend() == &backend && a.get()[99] == 5);
+
+    struct alignas(64) Line {
+        char bytes[64];
+    };
+    SafePointer<Line> lines(3, &backend);
+    assert(reinterpret_cast<uintptr_t>(lines.get()) % 64 == 0);
+    lines.reallocate(7);
+    assert(reinterpret_cast<uintptr_t>(lines.get()) % 64 == 0);
+    lines.deallocate();
+
+    void* raw = backend.allocate(24, 8);
+    backend.deallocate(raw, 24, 8);
+}
+
+#if SAFEPTR_HAS_PMR
+// Checks that every block is returned with the size and alignment it was allocated with.
+class CheckingResource : public std::pmr::memory_resource
+{
+public:
+    std::unordered_map<void*, std::pair<size_t, size_t>> live;
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        void* ptr = std::pmr::new_delete_resource()->allocate(bytes, align);
+        live[ptr] = {bytes, align};
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+        assert(live.count(ptr) && live[ptr] == std::make_pair(bytes, align));
+        live.erase(ptr);
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+void test_pmr_backend() {
+    CheckingResource checking;
+    {
+        PmrBackend backend(&checking);
+        SafePointer<double> a(10, &backend);
+        a.fill(2.5);
+        a.reallocate(1000);
+        assert(a.get()[9] == 2.5);
+        a.callocate(4, sizeof(double));
+        assert(a.get()[3] == 0.0);
+        SafePointer<double> b(&backend);
+        b.allocate(3);
+        assert(checking.live.size() == 2);
+        assert(backend.resource() == &checking);
+    }
+    assert(checking.live.empty());
+
+    // Storage from a request arena, emulated reallocation included
+    alignas(64) unsigned char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    PmrBackend request(&arena);
+    SafePointer<int> c(16, &request);
+    c.fill(3);
+    c.reallocate(32);
+    assert(c.get()[15] == 3);
+    assert(reinterpret_cast<unsigned char*>(c.get()) >= buffer && reinterpret_cast<unsigned char*>(c.get()) < buffer + sizeof(buffer));
+
+    // A SafePointer built straight from a resource carries its own adapter, which
+    // lives in the resource and goes away with the last pointer using it
+    {
+        std::pmr::monotonic_buffer_resource per_request;
+        SafePointer<int> direct(100, &per_request);
+        direct.fill(9);
+        direct.reallocate(200);
+        assert(direct.get()[99] == 9);
+        SafePointer<int> moved(std::move(direct));
+        assert(moved.backend() == direct.backend());
+        direct.allocate(10);  // still drawing from per_request
+        SafePointer<int> swapped(5);
+        swapped.swap(direct);
+        assert(static_cast<PmrBackend*>(swapped.backend())->resource() == &per_request);
+    }
+    {
+        CheckingResource counted;
+        {
+            SafePointer<double> d(8, &counted);
+            SafePointer<double> e(std::move(d));
+            assert(counted.live.size() == 2);  // adapter and block
+        }
+        assert(counted.live.empty());
+    }
+
+    // Exhausting the resource is reported like any other allocation failure
+    bool thrown = false;
+    try {
+        c.reallocate(4096);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && c.get()[15] == 3);
+}
+#endif
+
+// Pools the calling thread holds a cache entry for, destroyed ones not yet pruned included.
+struct PoolBackendProbe
+{
+    static size_t thread_cache_entries() { return PoolBackend::local_caches().entries.size(); }
+};
+
+void test_pool_backend() {
+    PoolBackend pool;
+    int* first;
+    {
+        SafePointer<int> a(10, &pool);
+        a.fill(7);
+        first = a.get();
+        assert(reinterpret_cast<uintptr_t>(first) % 16 == 0);
+        assert(pool.reserved() == PoolBackend::kChunkBytes);
+
+        // Growing within the 64-byte class keeps the block
+        a.reallocate(16);
+        assert(a.get() == first && a.get()[9] == 7);
+        a.reallocate(100);
+        assert(a.get() != first && a.get()[9] == 7);
+    }
+
+    // Freed blocks are reused from the thread's free list
+    SafePointer<int> b(12, &pool);
+    assert(b.get() == first);
+
+    // Large and over-aligned requests bypass the size classes
+    SafePointer<char> large(PoolBackend::kMaxPooled + 1, &pool);
+    large.fill('x');
+    void* aligned = pool.allocate(256, 64);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    pool.deallocate(aligned, 256, 64);
+
+    // Another thread gets its own cache
+    int* other = nullptr;
+    std::thread t([&] {
+        SafePointer<int> c(12, &pool);
+        other = c.get();
+    });
+    t.join();
+    assert(other != nullptr && other != b.get());
+
+    // Blocks freed on another thread return to the allocating thread's cache
+    int* produced = b.get();
+    std::thread consumer([&] { b.deallocate(); });
+    consumer.join();
+    SafePointer<int> d(12, &pool);
+    assert(d.get() == produced);
+
+    // Producer/consumer churn stays within the chunks already reserved
+    size_t reserved = pool.reserved();
+    for (int round = 0; round < 100; ++round) {
+        std::vector<SafePointer<char>> batch;
+        for (int i = 0; i < 64; ++i) {
+            batch.emplace_back(1000, &pool);
+        }
+        std::thread drain([&] { batch.clear(); });
+        drain.join();
+    }
+    assert(pool.reserved() <= reserved + PoolBackend::kChunkBytes);
+
+    // Short-lived pools do not pile up in the thread's cache table
+    size_t entries = PoolBackendProbe::thread_cache_entries();
+    for (int job = 0; job < 100; ++job) {
+        PoolBackend per_job;
+        SafePointer<char> scratch(100, &per_job);
+    }
+    assert(PoolBackendProbe::thread_cache_entries() <= entries + 1);
+}
+
+void test_percpu_pool() {
+#if defined(__linux__)
+    assert(safeptr_detail::current_cpu_id() >= 0);
+#endif
+
+    PerCpuPoolBackend pool;
+    {
+        SafePointer<int> a(10, &pool);
+        a.fill(4);
+        int* first = a.get();
+        a.reallocate(16);  // same 64-byte class
+        assert(a.get() == first && a.get()[9] == 4);
+        a.reallocate(1000);
+        assert(a.get()[9] == 4);
+        SafePointer<char> large(PerCpuPoolBackend::kMaxPooled * 2, &pool);
+        large.fill('y');
+    }
+
+    // Many threads allocating and freeing stay within a bounded number of chunks
+    std::vector<std::thread> threads;
+    std::atomic<bool> corrupted{false};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&pool, &corrupted, t] {
+            for (int round = 0; round < 200; ++round) {
+                std::vector<SafePointer<int>> blocks;
+                for (int i = 0; i < 16; ++i) {
+                    blocks.emplace_back(static_cast<size_t>(8 + (i * 37) % 500), &pool);
+                    blocks.back().fill(t * 1000 + i);
+                }
+                for (int i = 0; i < 16; ++i) {
+                    for (int v : blocks[i]) {
+                        if (v != t * 1000 + i) {
+                            corrupted = true;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    assert(!corrupted);
+    size_t bound = (pool.caches() + 8) * PerCpuPoolBackend::kClasses * PerCpuPoolBackend::kCacheBytes * 2;
+    assert(pool.reserved() <= bound + PerCpuPoolBackend::kChunkBytes);
+}
+
+void test_arena_backend() {
+    ArenaBackend arena(4096);
+    SafePointer<int> a(16, &arena);
+    int* first = a.get();
+    a.reallocate(64);  // most recent block grows in place
+    assert(a.get() == first);
+    SafePointer<double> b(4, &arena);
+    assert(reinterpret_cast<uintptr_t>(b.get()) % alignof(double) == 0);
+    assert(arena.used() == 64 * sizeof(int) + 4 * sizeof(double));
+
+    b.deallocate();  // rolled back: the next block takes its place
+    SafePointer<double> c(4, &arena);
+    assert(arena.used() == 64 * sizeof(int) + 4 * sizeof(double));
+
+    SafePointer<char> big(10000, &arena);  // larger than a chunk
+    assert(arena.reserved() >= 4096 + 10000);
+    c.deallocate();
+    big.deallocate();
+    a.deallocate();
+    arena.reset();
+    assert(arena.reserved() == 0);
+}
+
+void test_safe_allocator() {
+    PoolBackend pool;
+    SafeAllocator<int> alloc(&pool);
+    {
+        std::vector<int, SafeAllocator<int>> v(alloc);
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+        assert(v[999] == 999);
+        assert(v.get_allocator().backend() == &pool);
+        assert(pool.reserved() > 0);
+
+        // Node-based containers rebind to their node type and keep the backend
+        using Map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                       SafeAllocator<std::pair<const int, int>>>;
+        Map m(16, std::hash<int>(), std::equal_to<int>(), SafeAllocator<std::pair<const int, int>>(alloc));
+        for (int i = 0; i < 100; ++i) {
+            m[i] = i * 2;
+        }
+        assert(m.at(42) == 84);
+        assert(m.get_allocator() == alloc);
+    }
+
+    ArenaBackend arena;
+    SafeAllocator<double> other(&arena);
+    assert(other != alloc);
+    assert(SafeAllocator<char>().backend() == &SafeBackend::get_default());
+    std::vector<double, SafeAllocator<double>> w(100, 1.5, other);
+    assert(arena.used() >= 100 * sizeof(double));
+
+    bool thrown = false;
+    try {
+        alloc.allocate(SIZE_MAX / 2);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_memory_tags() {
+    SafeTagBackend& index = SafeMemoryTags::get("test.index");
+    assert(&SafeMemoryTags::get("test.index") == &index);
+    {
+        SafePointer<char> explicit_tag(1000, &index);
+        assert(index.live_bytes() == 1000);
+        explicit_tag.reallocate(3000);
+        assert(index.live_bytes() == 3000);
+
+        // Scoped tagging applies to pointers that pick up the default backend
+        SafePointer<char> outside;
+        {
+            SafeTagScope scope("test.request");
+            SafePointer<char> inside(500);
+            assert(inside.backend() == &SafeMemoryTags::get("test.request"));
+            {
+                SafeTagScope nested(index);
+                outside.allocate(100);
+            }
+            SafePointer<char> copy = inside.clone();
+            assert(SafeMemoryTags::get("test.request").live_bytes() == 1000);
+        }
+        assert(&SafeBackend::get_default() == &MallocBackend::instance());
+        assert(SafeMemoryTags::get("test.request").live_bytes() == 0);
+        assert(index.live_bytes() == 3100);
+    }
+    assert(index.live_bytes() == 0);
+
+    // Per-CPU counts from many threads add up; peaks beyond a batch are recorded
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&index] {
+            std::vector<SafePointer<char>> blocks;
+            for (int i = 0; i < 64; ++i) {
+                blocks.emplace_back(16384, &index);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    assert(index.live_bytes() == 0);
+    assert(index.peak_bytes() >= static_cast<size_t>(SafeTagCounter::kBatch));
+
+    // Tags allocate from the default in effect when they were created
+    static PoolBackend base;  // outlives the registered tags
+    SafeBackend::set_default(&base);
+    {
+        SafeTagScope outer("test.outer");
+        SafeTagBackend& inner = SafeMemoryTags::get("test.inner");
+        assert(inner.upstream() == &base);
+        assert(SafeMemoryTags::get("test.outer").upstream() == &base);
+        SafePointer<char> buf(2000, &inner);
+        assert(inner.live_bytes() == 2000 && base.reserved() > 0);
+        assert(SafeMemoryTags::get("test.outer").live_bytes() == 0);
+        assert(&SafeMemoryTags::get("test.inner", &base) == &inner);
+    }
+    SafeBackend::set_default(nullptr);
+
+    // A short-lived thread default is never captured by a registry tag
+    {
+        ArenaBackend request;
+        SafeBackend* previous = SafeBackend::set_thread_default(&request);
+        {
+            SafeTagScope scope("test.request-scoped");
+            assert(SafeMemoryTags::get("test.request-scoped").upstream() == &MallocBackend::instance());
+        }
+        SafeTagBackend local("test.local");  // caller-owned tags may use it
+        assert(local.upstream() == &request);
+        SafeBackend::set_thread_default(previous);
+    }
+    {
+        SafePointer<char> later(100, &SafeMemoryTags::get("test.request-scoped"));
+        assert(SafeMemoryTags::get("test.request-scoped").live_bytes() == 100);
+    }
+    bool mismatch = false;
+    try {
+        SafeMemoryTags::get("test.inner", &MallocBackend::instance());
+    } catch (const std::invalid_argument&) {
+        mismatch = true;
+    }
+    assert(mismatch);
+
+    bool found = false;
+    for (const SafeTagStats& stats : SafeMemoryTags::snapshot()) {
+        found = found || (stats.name == "test.index" && stats.live_bytes == 0);
+    }
+    assert(found);
+}
+
+void test_deferred_free() {
+    SafeTagBackend counted("test.deferred");
+    {
+        SafeDeferredFreeOptions options;
+        options.interval = std::chrono::hours(1);  // only the batch threshold wakes the reclaimer
+        options.batch_bytes = 8 << 20;
+        DeferredFreeBackend deferred(options, &counted);
+
+        SafePointer<char> small(1000, &deferred);
+        SafePointer<char> large(2 << 20, &deferred);
+        large.fill('x');
+        small.deallocate();
+        large.deallocate();  // returns before the block is freed
+        assert(counted.live_bytes() == 2 << 20);
+        assert(deferred.pending_bytes() == 2 << 20);
+        assert(deferred.drain() == 2 << 20);
+        assert(counted.live_bytes() == 0);
+
+        // Crossing batch_bytes wakes the reclaimer
+        for (int i = 0; i < 5; ++i) {
+            SafePointer<char> block(2 << 20, &deferred);
+        }
+        for (int i = 0; i < 1000 && counted.live_bytes() != 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(counted.live_bytes() <= 2 << 20);
+
+        SafePointer<char> left(4 << 20, &deferred);
+    }
+    assert(counted.live_bytes() == 0);  // destruction frees whatever is pending
+
+    // Byte-aligned upstream blocks can start at any address
+    ArenaBackend arena(1 << 20);
+    SafeDeferredFreeOptions options;
+    options.min_bytes = 64;
+    DeferredFreeBackend deferred(options, &arena);
+    SafePointer<char> odd(3, &deferred);
+    SafePointer<char> unaligned(100, &deferred);
+    assert(reinterpret_cast<uintptr_t>(unaligned.get()) % alignof(void*) != 0);
+    unaligned.deallocate();
+    assert(deferred.drain() == 100);
+}
+
+void test_trace_replay() {
+    const char* path = "safeptr_trace_test.bin";
+    {
+        TraceRecorderBackend recorder(path);
+        SafeBackend::set_default(&recorder);
+        {
+            SafePointer<int> a(100);
+            a.fill(1);
+            a.reallocate(200);
+            SafePointer<int> b = a.clone();
+            assert(b.get()[50] == 1);
+        }
+        SafeBackend::set_default(nullptr);
+        assert(recorder.events() == 6);
+    }
+
+    std::vector<SafeTraceEvent> events = read_trace(path);
+    std::remove(path);
+    assert(events.size() == 6);
+    const uint16_t kinds[] = {SafeTraceEvent::kAllocate, SafeTraceEvent::kReallocate, SafeTraceEvent::kAllocate,
+                              SafeTraceEvent::kClone, SafeTraceEvent::kDeallocate, SafeTraceEvent::kDeallocate};
+    for (size_t i = 0; i < events.size(); ++i) {
+        assert(events[i].kind == kinds[i]);
+        assert(events[i].align == (events[i].kind == SafeTraceEvent::kClone ? 0 : alignof(int)));
+    }
+    assert(events[1].id == events[0].id && events[1].bytes == 800);
+    assert(events[3].id == events[2].id && events[3].source == events[0].id);
+    assert(events[4].id == events[2].id && events[5].id == events[0].id);
+
+    PoolBackend pool;
+    ArenaBackend arena;
+    SafeBackend* backends[] = {&MallocBackend::instance(), &pool, &arena};
+    for (SafeBackend* backend : backends) {
+        SafeReplayStats stats = replay_trace(events, *backend);
+        assert(stats.events == 6 && stats.failures == 0);
+        assert(stats.peak_live_bytes == 1600);
+    }
+
+    bool thrown = false;
+    try {
+        read_trace("safeptr_trace_missing.bin");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void test_buffer_chain() {
+    const char header[] = "HDR:";
+    SafePointer<char> payload(300000);
+    payload.fill('p');
+    SafePointer<uint32_t> trailer(2);
+    trailer.fill(0x41414141);  // "AAAA"
+
+    SafeBufferChain chain;
+    chain.append(std::move(payload));
+    chain.append(std::move(trailer));
+    chain.prepend(header, 4);
+    assert(!payload.is_allocated());  // adopted, not copied
+    assert(chain.segments() == 3 && chain.size() == 4 + 300000 + 8);
+    chain.append(std::move(chain));  // self-append is a no-op
+    assert(chain.segments() == 3 && chain.size() == 4 + 300000 + 8);
+
+    // A pipe holds less than the chain, so the writer sees partial writes
+    int fds[2];
+    int rc = pipe(fds);
+    assert(rc == 0);
+    std::string received;
+    std::thread reader([&] {
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+            received.append(buf, static_cast<size_t>(n));
+        }
+    });
+    chain.write_all(fds[1]);
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+    assert(chain.empty() && chain.segments() == 0);
+    assert(received.size() == 4 + 300000 + 8);
+    assert(received.compare(0, 4, "HDR:") == 0 && received[4] == 'p' && received[300003] == 'p');
+    assert(received.compare(300004, 8, "AAAAAAAA") == 0);
+
+    // Non-blocking descriptors keep whatever did not fit queued
+    rc = pipe(fds);
+    assert(rc == 0);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    SafePointer<char> big(1 << 20);
+    big.fill('b');
+    chain.append(std::move(big));
+    size_t first = chain.write_some(fds[1]);
+    assert(first > 0 && first < (1u << 20) && chain.size() == (1u << 20) - first);
+    assert(chain.write_some(fds[1]) == 0);
+    close(fds[0]);
+    close(fds[1]);
+    chain.consume(chain.size() - 10);
+    assert(chain.size() == 10);
+    chain.clear();
+
+    // Positional writes leave the file offset alone
+    char path[] = "/tmp/safeptr_chain_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+    std::vector<char> parts(3000);
+    for (size_t i = 0; i < parts.size(); ++i) {
+        parts[i] = static_cast<char>('a' + i % 26);
+    }
+    for (size_t off = 0; off < parts.size(); off += 100) {
+        chain.append(parts.data() + off, 100);
+    }
+    chain.write_all_at(fd, 10);
+    assert(lseek(fd, 0, SEEK_CUR) == 0);
+    char back[3000];
+    ssize_t n = pread(fd, back, sizeof(back), 10);
+    assert(n == 3000);
+    assert(memcmp(back, parts.data(), sizeof(back)) == 0);
+    close(fd);
+}
+#endif
+
+#if defined(__linux__)
+void test_splice() {
+    PageBackend& pages = PageBackend::instance();
+    SafePointer<char> buf(3 * pages.page_size() + 100, &pages);
+    assert(reinterpret_cast<uintptr_t>(buf.get()) % pages.page_size() == 0);
+    for (size_t i = 0; i < buf.size(); ++i) {
+        buf.get()[i] = static_cast<char>('a' + i % 26);
+    }
+    size_t filled = buf.size();
+    buf.reallocate(400000);  // mremap keeps the contents
+    for (size_t i = 0; i < filled; ++i) {
+        assert(buf.get()[i] == static_cast<char>('a' + i % 26));
+    }
+    for (size_t i = filled; i < buf.size(); ++i) {
+        buf.get()[i] = static_cast<char>('a' + i % 26);
+    }
+    SafePointer<char> copy = buf.clone();
+
+    // Gifted pages reach the pipe's reader; the buffer itself is gone
+    int fds[2];
+    int rc = pipe(fds);
+    assert(rc == 0);
+    std::string received;
+    std::thread reader([&] {
+        char chunk[65536];
+        ssize_t n;
+        while ((n = read(fds[0], chunk, sizeof(chunk))) > 0) {
+            received.append(chunk, static_cast<size_t>(n));
+        }
+    });
+    size_t sent = vmsplice_gift(std::move(buf), fds[1]);
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+    assert(!buf.is_allocated());
+    assert(sent == 400000 && received.size() == 400000);
+    assert(memcmp(received.data(), copy.get(), 400000) == 0);
+
+    // Pages moved on into a file
+    char path[] = "/tmp/safeptr_splice_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+    SafePointer<char> out(400000, &pages);
+    out.set_values(copy.get(), copy.get() + copy.size());
+    assert(splice_to_file(std::move(out), fd, 4096) == 400000);
+    std::vector<char> back(400000);
+    ssize_t n = pread(fd, back.data(), back.size(), 4096);
+    assert(n == 400000);
+    assert(memcmp(back.data(), copy.get(), back.size()) == 0);
+    close(fd);
+
+    // Storage that is not whole mapped pages cannot be gifted
+    bool thrown = false;
+    try {
+        vmsplice_gift(std::move(copy), 1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+#endif
+
 int unit() {
     // Run tests
     test_allocate_and_deallocate();
@@ -159,6 +1455,40 @@ int unit() {
     test_copy();
     test_swap();
     test_clear();
+    test_parallel();
+    test_expressions();
+    test_incremental();
+    test_seqlock();
+    test_padded();
+    test_scratch();
+    test_triple_buffer();
+    test_convert();
+    test_half();
+    test_layout();
+    test_copy_engine();
+    test_move_within();
+    test_static_table();
+    test_operator_new_backend();
+#if SAFEPTR_HAS_PMR
+    test_pmr_backend();
+#endif
+    test_pool_backend();
+    test_percpu_pool();
+    test_arena_backend();
+    test_safe_allocator();
+    test_memory_tags();
+    test_deferred_free();
+    test_trace_replay();
+#if defined(__unix__) || defined(__APPLE__)
+    test_guard_sampling();
+    test_buffer_chain();
+#endif
+#if defined(__linux__)
+    test_splice();
+#endif
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+    test_coroutines();
+#endif
 
     std::cout << "All tests passed!" << std::endl;
     return 0;